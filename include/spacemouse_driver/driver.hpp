@@ -20,12 +20,16 @@
 
 #include <memory>
 #include <atomic>
+#include <cstdint>
 #include <functional>
 #include <chrono>
+#include <string>
 
 #include "spacemouse_driver/input_types.hpp"
 #include "spacemouse_driver/connection_state.hpp"
 #include "spacemouse_driver/device_model.hpp"
+#include "spacemouse_driver/subscription.hpp"
+#include "spacemouse_driver/statistics.hpp"
 
 namespace spacemouse_driver {
 
@@ -35,6 +39,7 @@ class CallbackDispatcher;
 class ConnectionMethod;
 class DriverContext;
 class DeviceHandle;
+struct DriverDiagnostics;
 
 /**
  * @brief Main driver class for controlling SpaceMouse devices
@@ -80,8 +85,60 @@ public:
    */
   Input read_input() const;
 
+  /**
+   * @brief Copies the current input state into a caller-provided object
+   *
+   * The copy is always a consistent frame, even when new reports arrive while it is taken.
+   *
+   * @param input Object receiving the most recent input data
+   * @return Frame number of the copied input, 0 if no input was received yet.
+   *         Every new report and every disconnect increments it.
+   */
+  uint64_t read_input(Input& input) const;
+
+  /**
+   * @brief Reads every frame received after a given one
+   *
+   * Frames are kept in a ring of DriverManagerOptions::input_history_size entries. A consumer
+   * polling slower than the device reports gets all frames it missed, as long as it polls before
+   * the ring wraps around. Frames that were already overwritten are counted instead.
+   *
+   * @param sequence Last frame number the caller has seen, 0 to read the whole history
+   * @param frames Output array receiving the frames, oldest first
+   * @param max_frames Capacity of the output array
+   * @return Number of copied and lost frames, and the sequence to pass to the next call
+   * @note Returns no frames when the history is disabled
+   */
+  InputHistoryRead read_input_since(uint64_t sequence, Input* frames, size_t max_frames) const;
+
+  /**
+   * @brief Waits until an input frame newer than a given one is available
+   *
+   * Blocks the calling thread without polling, an alternative to callbacks for consumers that
+   * run their own loop. Returns immediately if a newer frame was already received.
+   *
+   * @param last_sequence Last frame number the caller has seen, as returned by read_input()
+   * @param timeout Maximum time to wait
+   * @param input Object receiving the newest input data
+   * @return Frame number of the copied input, 0 if the timeout expired first
+   */
+  uint64_t wait_for_input(
+    uint64_t last_sequence, std::chrono::milliseconds timeout,
+    Input& input) const;
+
   // Callback registration
 
+  /**
+   * @brief Registers a callback function receiving complete input frames
+   *
+   * Called before the stick and button callbacks with every dispatched frame, including its
+   * sequence number and the time its report was read.
+   *
+   * @param callback Function to call
+   * @note Only one input callback can be registered at a time. Calling it again overrides the previous one.
+   */
+  void register_input_callback(std::function<void(const Input&)> callback);
+
   /**
    * @brief Registers a callback function for stick input events
    *
@@ -98,11 +155,84 @@ public:
    */
   void register_button_callback(Button button, std::function<void(ButtonInput)> callback);
 
+  /**
+   * @brief Registers a callback function receiving all button changes at once
+   *
+   * Called once per dispatched frame in which any button changed, before the per-button callbacks.
+   * A frame in which a button changed twice is reported in two calls.
+   *
+   * @param callback Function to call with the mask of pressed buttons and the mask of buttons
+   *                 whose state changed, bit N corresponds to the button with enum index N
+   * @note Only one button mask callback can be registered at a time. Calling it again overrides the previous one.
+   */
+  void register_button_mask_callback(std::function<void(ButtonMask, ButtonMask)> callback);
+
+  /**
+   * @brief Registers a callback function receiving every button press and release
+   *
+   * Edges are detected on every report and queued until the next dispatch, so a click shorter
+   * than the callback interval is still reported as a press followed by a release. The per-button
+   * and button mask callbacks are driven by the same events.
+   *
+   * @param callback Function to call with each edge, in the order they were reported
+   * @note Only one button event callback can be registered at a time. Calling it again overrides the previous one.
+   */
+  void register_button_event_callback(std::function<void(const ButtonEvent&)> callback);
+
+  /**
+   * @brief Registers a callback function receiving the stick motion of every interval tick
+   *
+   * Called on every tick of the interval set with set_callback_interval(), with the axis values
+   * integrated over the time since the previous tick. Motion between two ticks is therefore
+   * never lost, whatever the ratio of the report rate to the callback rate.
+   *
+   * @param callback Function to call
+   * @note Only one motion callback can be registered at a time. Calling it again overrides the previous one.
+   */
+  void register_motion_callback(std::function<void(const StickMotion&)> callback);
+
+  /**
+   * @brief Subscribes to input frames with a delivery rate and coalescing policy of its own
+   *
+   * Any number of subscriptions can coexist, e.g. a control loop receiving every frame instantly
+   * next to a UI sampling the state at 30 Hz. All of them are scheduled by the dispatcher of the
+   * driver, independently of the callbacks registered with the other methods and of
+   * set_instant_callbacks() and set_callback_interval().
+   *
+   * @param callback Function to call with every delivered frame
+   * @param options Delivery rate and coalescing policy
+   * @return Handle keeping the subscription alive, destroying it unsubscribes
+   * @throws std::invalid_argument If the callback is empty, the interval is not positive, inline
+   *         execution is combined with interval delivery or an executor is missing
+   * @note Coalescing::EverySample reads the input history and falls back to Coalescing::Latest
+   *       when the history is disabled, except for instant inline and executor subscriptions
+   *       which receive every frame directly
+   * @note Inline callbacks delay reading the next report, they must return quickly
+   */
+  [[nodiscard]] Subscription subscribe(
+    std::function<void(const Input&)> callback,
+    SubscriptionOptions options = SubscriptionOptions{ });
+
+  /**
+   * @brief Removes the currently registered input callback
+   */
+  void delete_input_callback();
+
   /**
    * @brief Removes the currently registered stick callback
    */
   void delete_stick_callback();
 
+  /**
+   * @brief Removes the currently registered button event callback
+   */
+  void delete_button_event_callback();
+
+  /**
+   * @brief Removes the currently registered motion callback
+   */
+  void delete_motion_callback();
+
   /**
    * @brief Removes the callback for a specific button
    *
@@ -110,6 +240,11 @@ public:
    */
   void delete_button_callback(Button button);
 
+  /**
+   * @brief Removes the currently registered button mask callback
+   */
+  void delete_button_mask_callback();
+
   // Configuration
 
   /**
@@ -125,13 +260,34 @@ public:
   /**
    * @brief Sets the interval for callback execution when instant callbacks are disabled
    *
-   * @param interval Time interval between callback executions
+   * Callbacks run on absolute deadlines, so the period does not drift with the time the callbacks
+   * take. Ticks that are missed entirely are skipped rather than run back to back.
+   *
+   * @param interval Time interval between callback executions, may be below one millisecond
+   * @throws std::invalid_argument If the interval is not positive
+   * @note Default value is 20 milliseconds
+   */
+  void set_callback_interval(std::chrono::microseconds interval);
+
+  /**
+   * @brief Chooses the stick value passed to the stick callback on interval ticks
+   *
+   * With Coalescing::Mean the callback receives the time-weighted mean of the stick since the
+   * previous tick instead of the last reported value, so short motions between two ticks still
+   * show up. Instant callbacks always receive the reported value.
+   *
+   * @param coalescing Coalescing::Latest (default) or Coalescing::Mean
+   * @throws std::invalid_argument If coalescing is Coalescing::EverySample
    */
-  void set_callback_interval(std::chrono::milliseconds interval);
+  void set_interval_coalescing(Coalescing coalescing);
 
   /**
    * @brief Sets the retry interval for connection attempts
    *
+   * Connection attempts are normally triggered by hotplug events. The retry interval is used when
+   * the driver cannot subscribe to them, and as the longest delay between retries while a present
+   * device cannot be opened, e.g. because another process holds it.
+   *
    * @param interval Time to wait between connection retry attempts
    * @note Default value is 1000 milliseconds
    */
@@ -153,9 +309,56 @@ public:
    */
   std::optional<Model> get_connected_model() const;
 
+  /**
+   * @brief Gets the timing statistics of the interval callback execution
+   *
+   * @return Lateness of the ticks relative to their deadlines and the number of missed ticks
+   */
+  JitterStats get_callback_jitter() const;
+
+  /**
+   * @brief Gets a snapshot of the operational counters of the driver
+   *
+   * Reading the counters takes a few relaxed loads and never blocks the driver, it can be polled
+   * by monitoring at any rate.
+   *
+   * @return Counters since the driver was created
+   */
+  DriverCounters get_counters() const;
+
+  // Diagnostics
+
+  /**
+   * @brief Writes the recent internal events of the driver to a file
+   *
+   * The driver always records its last few thousand events (reads, parsing, publishing, callback
+   * execution, connection changes) into a binary ring. The dump can be converted to Chrome trace
+   * JSON with tools/trace_to_chrome.py and opened in chrome://tracing or Perfetto.
+   *
+   * @param path File to write, replaced if it exists
+   * @return true if the file was written
+   */
+  bool dump_trace(const std::string& path) const;
+
+  /**
+   * @brief Gets the latency of the processing stages between reading a report and the callbacks
+   *
+   * Measured for every frame and callback run since the driver was created or the statistics
+   * were last reset.
+   *
+   * @return Percentiles and maximum of each stage
+   */
+  LatencyStats get_latency_stats() const;
+
+  /**
+   * @brief Discards the measurements returned by get_latency_stats()
+   */
+  void reset_latency_stats();
+
 private:
   std::shared_ptr<DriverContext> _context;
   std::atomic<bool> _running;
+  std::unique_ptr<DriverDiagnostics> _diagnostics;  // Outlives the components recording into it
 
   // Component modules
   std::unique_ptr<ConnectionManager> _connection_manager;
@@ -20,9 +20,12 @@
 
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "spacemouse_driver/logger.hpp"
+#include "spacemouse_driver/driver_manager_options.hpp"
+#include "spacemouse_driver/statistics.hpp"
 
 namespace spacemouse_driver {
 
@@ -62,13 +65,23 @@ public:
 
   ~DriverManager();
 
+  /**
+   * @brief Constructs a DriverManager with default console logging and custom options
+   *
+   * @param options Options applied to every driver created by this manager
+   */
+  explicit DriverManager(const DriverManagerOptions& options);
+
   /**
    * @brief Constructs a DriverManager with custom logger
    *
    * @param logger Custom logger implementation to use for driver operations
    * @param log_level Initial logging level to set
+   * @param options Options applied to every driver created by this manager
    */
-  explicit DriverManager(std::unique_ptr<Logger> logger, LogLevel log_level = LogLevel::Warning);
+  explicit DriverManager(
+    std::unique_ptr<Logger> logger, LogLevel log_level = LogLevel::Warning,
+    const DriverManagerOptions& options = DriverManagerOptions());
 
   /**
    * @brief Sets the logging level for all driver operations
@@ -117,8 +130,18 @@ public:
    */
   std::shared_ptr<Driver> create_driver(const std::string& device_path);
 
+  /**
+   * @brief Gets the operational counters summed over all drivers created by this manager
+   *
+   * The maximum reconnect time is the largest of all drivers.
+   *
+   * @return Aggregate of Driver::get_counters() of every driver
+   */
+  DriverCounters get_counters() const;
+
 private:
   std::shared_ptr<DriverContext> _context;
+  mutable std::mutex _drivers_mutex;
   std::vector<std::shared_ptr<Driver>> _drivers;
 
   std::shared_ptr<Driver> make_driver(const std::shared_ptr<ConnectionMethod>& conn_method);
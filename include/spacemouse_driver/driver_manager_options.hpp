@@ -0,0 +1,53 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace spacemouse_driver {
+
+/**
+ * @brief Enumeration of HID backends used to talk to the devices
+ */
+enum class BackendType
+{
+  Hidapi,  // hidapi library, reads are polled with a timeout
+  Hidraw,  // Direct /dev/hidrawN access, reads sleep until the kernel queues a report
+};
+
+/**
+ * @brief Enumeration of threading models used by the drivers of a DriverManager
+ */
+enum class ThreadingMode
+{
+  PerDriver,      // Every driver runs its own connection, input and dispatch threads
+  SharedReactor,  // One I/O thread serves all drivers, callbacks run on a shared worker pool
+};
+
+/**
+ * @brief Configuration shared by all drivers created by a DriverManager
+ */
+struct DriverManagerOptions {
+  BackendType backend = BackendType::Hidapi;  // Backend used for enumeration and device I/O
+  ThreadingMode threading = ThreadingMode::PerDriver;  // SharedReactor requires the Hidraw backend
+  size_t worker_threads = 2;  // Callback worker threads in SharedReactor mode
+  size_t input_history_size = 256;  // Frames kept for Driver::read_input_since(), 0 disables
+};
+
+}  // namespace spacemouse_driver
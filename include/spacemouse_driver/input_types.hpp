@@ -23,6 +23,7 @@
 #include <variant>
 #include <chrono>
 #include <string>
+#include <cstdint>
 
 #include "magic_enum/magic_enum.hpp"
 
@@ -90,27 +91,42 @@ constexpr size_t ButtonCount = magic_enum::enum_count<Button>();
 /**
  * @brief Represents input from the SpaceMouse stick
  *
- * Contains normalized values for all six degrees of freedom.
- * Values typically range from -1.0 to 1.0, where 0.0 represents no movement.
+ * Holds the raw values reported by the device for all six degrees of freedom. Normalized values
+ * typically range from -1.0 to 1.0, where 0.0 represents no movement, and are computed only when
+ * read, in the precision chosen by the caller.
  */
 struct StickInput {
-  std::array<double, AxisCount> axis;  // Array of axis values indexed by Axis enum
+  std::array<int16_t, AxisCount> raw;  // Raw device values indexed by Axis enum
+  int16_t divisor = 1;  // Raw value of a full deflection, used for normalization
 
+  // Compares raw values only, the divisor is constant for a device
   bool operator==(const StickInput& other) const {
-    for (size_t i = 0; i < AxisCount; ++i) {
-      if (axis[i] != other.axis[i]) {
-        return false;
-      }
-    }
-    return true;
+    return raw == other.raw;
   }
 
   bool operator!=(const StickInput& other) const {
     return !(*this == other);
   }
 
-  auto operator[](Axis a) const {
-    return axis[*magic_enum::enum_index(a)];
+  /**
+   * @brief Normalized value of an axis in double precision
+   */
+  double operator[](Axis a) const {
+    return static_cast<double>(get_raw(a)) / divisor;
+  }
+
+  /**
+   * @brief Normalized value of an axis in single precision
+   */
+  float get_float(Axis a) const {
+    return static_cast<float>(get_raw(a)) / divisor;
+  }
+
+  /**
+   * @brief Raw value of an axis as reported by the device
+   */
+  int16_t get_raw(Axis a) const {
+    return raw[*magic_enum::enum_index(a)];
   }
 };
 
@@ -121,6 +137,47 @@ struct StickInput {
  */
 using ButtonInput = bool;
 
+/**
+ * @brief Bit mask of button states
+ *
+ * Bit N corresponds to the button with enum index N, a set bit means the button is pressed.
+ */
+using ButtonMask = uint32_t;
+static_assert(ButtonCount <= 32, "Button states must fit in a ButtonMask");
+
+/**
+ * @brief Pressed state of all buttons, packed into a bit mask
+ *
+ * Indexing works like the array of flags it replaces.
+ */
+struct ButtonStates {
+  ButtonMask mask;  // Bit N is set while the button with enum index N is pressed
+
+  ButtonInput operator[](size_t index) const {
+    return ((mask >> index) & 1u) != 0;
+  }
+
+  ButtonInput operator[](Button b) const {
+    return (*this)[*magic_enum::enum_index(b)];
+  }
+
+  void set(size_t index, ButtonInput pressed) {
+    mask = pressed ? (mask | (1u << index)) : (mask & ~(1u << index));
+  }
+
+  constexpr size_t size() const {
+    return ButtonCount;
+  }
+
+  bool operator==(const ButtonStates& other) const {
+    return mask == other.mask;
+  }
+
+  bool operator!=(const ButtonStates& other) const {
+    return mask != other.mask;
+  }
+};
+
 /**
  * @brief Complete input state from a SpaceMouse device
  *
@@ -129,18 +186,13 @@ using ButtonInput = bool;
  */
 struct Input {
   StickInput stick;  // Current stick position and orientation
-  std::array<ButtonInput, ButtonCount> buttons;  // State of all buttons indexed by Button enum
+  ButtonStates buttons;  // State of all buttons indexed by Button enum
+  uint32_t report_count;  // Device reports merged into this frame, not compared
+  uint64_t sequence;  // Frame number within the driver, starting at 1, not compared
+  std::chrono::steady_clock::time_point timestamp;  // Time the report was read, not compared
 
   bool operator==(const Input& other) const {
-    if (stick != other.stick) {
-      return false;
-    }
-    for (size_t i = 0; i < ButtonCount; ++i) {
-      if (buttons[i] != other.buttons[i]) {
-        return false;
-      }
-    }
-    return true;
+    return stick == other.stick && buttons == other.buttons;
   }
 
   bool operator!=(const Input& other) const {
@@ -148,7 +200,7 @@ struct Input {
   }
 
   auto operator[](const Button& b) const {
-    return buttons[*magic_enum::enum_index(b)];
+    return buttons[b];
   }
 
   auto operator[](const Axis& a) const {
@@ -156,4 +208,45 @@ struct Input {
   }
 };
 
+/**
+ * @brief Press or release of a single button
+ *
+ * Edges are detected on every report, so a press and release arriving between two dispatches
+ * still produce two events.
+ */
+struct ButtonEvent {
+  Button button;
+  ButtonInput pressed;  // True for a press, false for a release
+  uint64_t sequence;  // Number of the frame that carried the change
+  std::chrono::steady_clock::time_point timestamp;  // Time the report was read
+};
+
+/**
+ * @brief Stick motion integrated over a dispatch interval
+ *
+ * Every axis value is weighted by the time it was held, so motion between two interval ticks is
+ * not lost when callbacks run less often than the device reports.
+ */
+struct StickMotion {
+  std::array<double, AxisCount> displacement;  // Normalized value integrated over the interval, in seconds, indexed by Axis enum
+  std::chrono::nanoseconds duration;  // Length of the interval
+  StickInput mean;  // Time-weighted mean of the raw values over the interval
+
+  /**
+   * @brief Integrated displacement of an axis
+   */
+  double operator[](Axis a) const {
+    return displacement[*magic_enum::enum_index(a)];
+  }
+};
+
+/**
+ * @brief Result of reading frames from the input history
+ */
+struct InputHistoryRead {
+  size_t count;            // Number of frames copied to the output
+  uint64_t overwritten;    // Frames newer than the requested one that were lost before being read
+  uint64_t last_sequence;  // Sequence to pass to the next read
+};
+
 }  // namespace spacemouse_driver
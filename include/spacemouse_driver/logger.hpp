@@ -25,6 +25,10 @@
 #include <iomanip>
 #include <fstream>
 #include <mutex>
+#include <atomic>
+#include <memory>
+#include <string_view>
+#include <type_traits>
 
 namespace spacemouse_driver {
 
@@ -42,6 +46,19 @@ enum class LogLevel
   Debug = 3
 };
 
+namespace detail {
+
+inline void append_log_part(std::string& message, std::string_view part) {
+  message.append(part);
+}
+
+template<typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+void append_log_part(std::string& message, T part) {
+  message.append(std::to_string(part));
+}
+
+}  // namespace detail
+
 /**
  * @brief Abstract base class for logging implementations
  *
@@ -52,7 +69,7 @@ class Logger
 {
 protected:
   std::mutex _log_mutex;
-  LogLevel _log_level = LogLevel::Info;
+  std::atomic<LogLevel> _log_level{ LogLevel::Info };
 
 public:
   virtual ~Logger() = default;
@@ -64,9 +81,38 @@ public:
    *
    * @param level New minimum logging level
    */
-  void set_log_level(LogLevel level) { _log_level = level; }
+  void set_log_level(LogLevel level) { _log_level.store(level, std::memory_order_relaxed); }
 
-  LogLevel get_log_level() const { return _log_level; }
+  LogLevel get_log_level() const { return _log_level.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Checks whether messages of a level are logged
+   *
+   * A single relaxed atomic load, cheap enough to guard building a message on hot paths.
+   *
+   * @param level Severity level to check
+   * @return true if messages of this level pass the current logging level
+   */
+  bool enabled(LogLevel level) const { return level <= get_log_level(); }
+
+  /**
+   * @brief Logs a message assembled from parts, if its level is enabled
+   *
+   * The level is checked before anything is formatted, so disabled messages cost no allocation.
+   * Parts can be strings, string literals and numbers.
+   *
+   * @param level Severity level of the message
+   * @param parts Parts of the message, concatenated in order
+   */
+  template<typename... Parts>
+  void log(LogLevel level, const Parts&... parts) {
+    if (!enabled(level)) {
+      return;
+    }
+    std::string message;
+    (detail::append_log_part(message, parts), ...);
+    log(message, level);
+  }
 
   /**
    * @brief Logs a message with specified level
@@ -102,11 +148,20 @@ public:
  * @brief Console-based logger implementation
  *
  * Outputs log messages to standard output (Info, Debug) and standard error (Warning, Error).
+ *
+ * Messages are queued and written by a background thread, so logging never waits for the
+ * console. If the queue is full, messages are dropped and their number is reported with the
+ * next written message. Messages longer than 255 bytes are truncated. Queued messages are written
+ * before the destructor returns.
  */
 class ConsoleLogger : public Logger
 {
 public:
-  ConsoleLogger() = default;
+  ConsoleLogger();
+  ~ConsoleLogger() override;
+
+  ConsoleLogger(const ConsoleLogger&) = delete;
+  ConsoleLogger& operator=(const ConsoleLogger&) = delete;
 
   /**
    * @brief Logs a message to console with appropriate formatting
@@ -114,37 +169,19 @@ public:
    * @param message Message to log
    * @param level Severity level of the message
    */
-  void log(const std::string& message, LogLevel level = LogLevel::Info) override {
-    std::lock_guard<std::mutex> lock(_log_mutex);
-    if (level <= _log_level) {
-      switch (level) {
-        case LogLevel::Error:
-          std::cerr << "[ERROR] : " << message << std::endl;
-          break;
-        case LogLevel::Warning:
-          std::cerr << "[WARNING] : " << message << std::endl;
-          break;
-        case LogLevel::Info:
-          std::cout << "[INFO] : " << message << std::endl;
-          break;
-        case LogLevel::Debug:
-          std::cout << "[DEBUG] : " << message << std::endl;
-          break;
-      }
-    }
-  }
+  void log(const std::string& message, LogLevel level = LogLevel::Info) override;
 
-  void warning(const std::string& message) override {
-    log(message, LogLevel::Warning);
-  }
+  void warning(const std::string& message) override;
 
-  void error(const std::string& message) override {
-    log(message, LogLevel::Error);
-  }
+  void error(const std::string& message) override;
 
-  void debug(const std::string& message) override {
-    log(message, LogLevel::Debug);
-  }
+  void debug(const std::string& message) override;
+
+  using Logger::log;
+
+private:
+  class Sink;
+  std::unique_ptr<Sink> _sink;
 };
 
 }  // namespace spacemouse_driver
@@ -19,8 +19,11 @@
 #pragma once
 
 #include "spacemouse_driver/driver_manager.hpp"
+#include "spacemouse_driver/driver_manager_options.hpp"
 #include "spacemouse_driver/driver.hpp"
 #include "spacemouse_driver/logger.hpp"
 #include "spacemouse_driver/input_types.hpp"
 #include "spacemouse_driver/device_model.hpp"
 #include "spacemouse_driver/connection_state.hpp"
+#include "spacemouse_driver/subscription.hpp"
+#include "spacemouse_driver/statistics.hpp"
@@ -0,0 +1,102 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace spacemouse_driver {
+
+/**
+ * @brief Timing statistics of a periodic dispatch
+ *
+ * Ticks are scheduled on absolute deadlines, so a late tick does not delay the following ones.
+ * Lateness is the time from the deadline of a tick to the moment it was dispatched.
+ */
+struct JitterStats {
+  uint64_t ticks;   // Ticks dispatched
+  uint64_t missed;  // Ticks skipped because an earlier one ran past their deadline
+  std::chrono::nanoseconds mean_lateness;
+  std::chrono::nanoseconds max_lateness;
+};
+
+/**
+ * @brief Delivery statistics of a subscription
+ *
+ * The handoff latency is the time from reading a report to calling the callback with the frame
+ * built from it. It covers the thread hops of the chosen Execution, and for interval delivery the
+ * wait for the next tick. Frames delivered again by interval sampling are not measured.
+ */
+struct SubscriptionStats {
+  uint64_t delivered;  // Callback invocations
+  uint64_t dropped;    // Frames discarded because the executor fell behind
+  std::chrono::nanoseconds mean_handoff;
+  std::chrono::nanoseconds max_handoff;
+  JitterStats jitter;  // Delivery::Interval only
+};
+
+/**
+ * @brief Latency distribution of one processing stage
+ *
+ * Percentiles are read from a log-linear histogram and are accurate to about 6%.
+ */
+struct LatencyPercentiles {
+  uint64_t count;  // Measurements taken
+  std::chrono::nanoseconds p50;
+  std::chrono::nanoseconds p99;
+  std::chrono::nanoseconds p999;
+  std::chrono::nanoseconds max;
+};
+
+/**
+ * @brief Latency of the stages between reading a report and running the callbacks
+ */
+struct LatencyStats {
+  LatencyPercentiles read_to_parse;        // Read returned to all merged reports parsed
+  LatencyPercentiles parse_to_publish;     // Frame parsed to visible to readers
+  LatencyPercentiles publish_to_dispatch;  // Frame published to picked up by the driver callbacks,
+                                           // includes the wait for the tick of interval callbacks
+  LatencyPercentiles callback;             // Execution time of callbacks and subscriptions
+};
+
+/**
+ * @brief Operational counters of a driver, or of all drivers of a DriverManager
+ *
+ * Counters only grow during the lifetime of a driver, rates are the difference of two snapshots.
+ */
+struct DriverCounters {
+  uint64_t reports;                // Reports read from the device, repeated ones included
+  uint64_t repeated_reports;       // Reports equal to the previous one of their ID, not published
+  uint64_t merged_reports;         // Reports queued behind an earlier one and merged into its frame
+  uint64_t frames;                 // Frames published
+  uint64_t read_errors;            // Failed reads, each one disconnects the device
+  uint64_t dispatched_frames;      // Frames picked up by the driver callbacks
+  uint64_t overwritten_frames;     // Frames replaced by a newer one before the driver callbacks ran.
+                                   // Expected with interval callbacks, a sign of saturation otherwise
+  uint64_t missed_ticks;           // Interval callback ticks skipped because an earlier one ran late
+  uint64_t dropped_button_events;  // Button changes lost because the callbacks fell behind
+  uint64_t connect_attempts;
+  uint64_t connects;
+  uint64_t disconnects;
+  uint64_t reconnects;             // Connections made after the device of the driver was lost
+  std::chrono::nanoseconds total_reconnect_time;  // From losing the device to connecting again
+  std::chrono::nanoseconds max_reconnect_time;
+};
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,144 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "spacemouse_driver/statistics.hpp"
+
+namespace spacemouse_driver {
+
+class SubscriptionRegistry;
+
+/**
+ * @brief Enumeration of subscription delivery rates
+ */
+enum class Delivery
+{
+  Instant,   // As soon as a new frame is received
+  Interval,  // Once per SubscriptionOptions::interval
+};
+
+/**
+ * @brief Enumeration of policies for frames received between two deliveries
+ */
+enum class Coalescing
+{
+  Latest,       // Only the newest frame is delivered
+  EverySample,  // Every frame is delivered in order, as far as the input history reaches back
+  Mean,         // The newest frame, with the stick replaced by its time-weighted mean since the previous
+                // delivery. Delivery::Interval only, behaves like Latest otherwise
+};
+
+/**
+ * @brief Enumeration of threads a subscription callback can run on
+ */
+enum class Execution
+{
+  Dispatcher,  // The dispatch thread of the driver, or the worker pool in SharedReactor mode
+  Inline,      // The thread reading the device, right after the frame is parsed. Delivery::Instant only
+  Executor,    // A user supplied CallbackExecutor
+};
+
+/**
+ * @brief Interface of a user supplied executor running subscription callbacks
+ *
+ * Lets callbacks run on a thread pool of the application. At most one task per subscription is
+ * queued or running at a time, so frames are delivered in order even by multi-threaded executors.
+ */
+class CallbackExecutor
+{
+public:
+  virtual ~CallbackExecutor() = default;
+
+  /**
+   * @brief Runs a task on a thread of the executor
+   *
+   * Called on the thread reading the device or on the dispatch thread, must not block.
+   */
+  virtual void execute(std::function<void()> task) = 0;
+};
+
+/**
+ * @brief Delivery settings of a single subscription
+ */
+struct SubscriptionOptions {
+  Delivery delivery = Delivery::Instant;
+  std::chrono::microseconds interval{ 20000 };  // Delivery period, used with Delivery::Interval only
+  Coalescing coalescing = Coalescing::Latest;
+  Execution execution = Execution::Dispatcher;
+  std::shared_ptr<CallbackExecutor> executor;  // Required by Execution::Executor
+};
+
+/**
+ * @brief Handle of a subscription created by Driver::subscribe()
+ *
+ * The subscription stays active as long as the handle exists. Destroying or resetting the handle
+ * unsubscribes, after which the callback is guaranteed not to be running or called again, unless
+ * the handle is reset from inside the callback itself.
+ */
+class Subscription
+{
+public:
+  Subscription() = default;
+  ~Subscription();
+
+  Subscription(Subscription&& other) noexcept;
+  Subscription& operator=(Subscription&& other) noexcept;
+  Subscription(const Subscription&) = delete;
+  Subscription& operator=(const Subscription&) = delete;
+
+  /**
+   * @brief Ends the subscription, does nothing if it already ended
+   *
+   * @note Waits for a delivery in progress on another thread, do not call it while holding a lock
+   *       the callback takes
+   */
+  void reset();
+
+  /**
+   * @brief Gets the delivery statistics of the subscription
+   *
+   * @return Statistics since subscribing, all zero if the subscription ended
+   */
+  SubscriptionStats get_stats() const;
+
+  /**
+   * @brief Checks whether the handle refers to a subscription
+   */
+  explicit operator bool() const {
+    return _id != 0;
+  }
+
+private:
+  friend class CallbackDispatcher;
+
+  Subscription(std::weak_ptr<SubscriptionRegistry> registry, uint64_t id)
+  : _registry(std::move(registry)),
+    _id(id) { }
+
+  std::weak_ptr<SubscriptionRegistry> _registry;
+  uint64_t _id = 0;
+};
+
+}  // namespace spacemouse_driver
@@ -18,6 +18,7 @@
 
 #include "connection/connection_manager.hpp"
 
+#include <algorithm>
 #include <future>
 #include <thread>
 
@@ -29,11 +30,40 @@ ConnectionManager::ConnectionManager(
 : _context(context),
   _conn_method(conn_method),
   _state(ConnectionState::Disconnected),
-  _running(false) {
+  _running(false),
+  _connect_timer(0),
+  _hotplug_listener(0),
+  _wake_requested(false),
+  _settle_attempts_left(0),
+  _open_retry_delay(0),
+  _connect_attempts(0),
+  _connects(0),
+  _disconnects(0),
+  _reconnects(0),
+  _total_reconnect_ns(0),
+  _max_reconnect_ns(0),
+  _lost_time(std::chrono::steady_clock::time_point{ }) {
+  if (_context->workers) {
+    _connect_task = std::make_unique<SerialTask>(
+      *_context->workers, [this] {
+        if (_running) {
+          attempt_connect();
+        }
+      });
+  }
+  if (_context->hotplug_monitor) {
+    _hotplug_listener = _context->hotplug_monitor->subscribe(
+      [this](const HotplugEvent& event) {
+        on_hotplug_event(event);
+      });
+  }
   _context->logger->debug("ConnectionManager initialized");
 }
 
 ConnectionManager::~ConnectionManager() {
+  if (_context->hotplug_monitor) {
+    _context->hotplug_monitor->unsubscribe(_hotplug_listener);
+  }
   stop();
   if (_state == ConnectionState::Connected) {
     disconnect();
@@ -46,6 +76,7 @@ bool ConnectionManager::try_connect() {
     return true;
   }
 
+  _connect_attempts.fetch_add(1, std::memory_order_relaxed);
   auto device = _conn_method->connect(_context);
   if (!device) {
     change_state(ConnectionState::Disconnected);
@@ -56,8 +87,20 @@ bool ConnectionManager::try_connect() {
     std::lock_guard<std::mutex> lock(_mutex);
     _device = device;
   }
+  _connects.fetch_add(1, std::memory_order_relaxed);
+  auto lost = _lost_time.exchange(std::chrono::steady_clock::time_point{ }, std::memory_order_relaxed);
+  if (lost != std::chrono::steady_clock::time_point{ }) {
+    auto reconnect_ns = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - lost).count());
+    _reconnects.fetch_add(1, std::memory_order_relaxed);
+    _total_reconnect_ns.fetch_add(reconnect_ns, std::memory_order_relaxed);
+    if (reconnect_ns > _max_reconnect_ns.load(std::memory_order_relaxed)) {
+      _max_reconnect_ns.store(reconnect_ns, std::memory_order_relaxed);
+    }
+  }
   change_state(ConnectionState::Connected);
-  _context->logger->log("Connected to SpaceMouse device: " + device->get_name());
+  _context->logger->log(LogLevel::Info, "Connected to SpaceMouse device: ", device->get_name());
   return true;
 }
 
@@ -67,7 +110,21 @@ void ConnectionManager::start() {
     return;
   }
   _running = true;
-  _connect_thread = std::thread(&ConnectionManager::connect_loop, this);
+  if (_context->reactor) {
+    _connect_timer = _context->reactor->add_timer(
+      Reactor::Clock::now(), [this] {
+        _connect_task->request();
+        std::lock_guard<std::mutex> lock(_wake_mutex);
+        auto delay = next_attempt_delay();
+        return std::optional(delay ? Reactor::Clock::now() + *delay : Reactor::Clock::time_point::max());
+      });
+  } else {
+    {
+      std::lock_guard<std::mutex> lock(_wake_mutex);
+      _wake_requested = true;
+    }
+    _connect_thread = std::thread(&ConnectionManager::connect_loop, this);
+  }
   _context->logger->debug("ConnectionManager started");
 }
 
@@ -75,7 +132,15 @@ void ConnectionManager::stop() {
   if (!_running) {
     return;
   }
-  _running = false;
+  {
+    std::lock_guard<std::mutex> lock(_wake_mutex);
+    _running = false;
+  }
+  _wake_cv.notify_all();
+  if (_context->reactor) {
+    _context->reactor->cancel_timer(_connect_timer);
+    _connect_task->wait_idle();
+  }
   if (_connect_thread.joinable()) {
     _connect_thread.join();
   }
@@ -83,17 +148,100 @@ void ConnectionManager::stop() {
   if( _state == ConnectionState::Connected) {
     disconnect();
   }
+  // A device released on purpose is not waited for
+  _lost_time.store(std::chrono::steady_clock::time_point{ }, std::memory_order_relaxed);
 
   _context->logger->debug("ConnectionManager stopped");
 }
 
 void ConnectionManager::connect_loop() {
   while (_running) {
-    std::this_thread::sleep_for(_connect_retry_interval.load());
-    if (_state == ConnectionState::Disconnected) {
-      try_connect();
+    {
+      std::unique_lock<std::mutex> lock(_wake_mutex);
+      auto wake_condition = [this] {
+        return !_running || _wake_requested;
+      };
+      auto delay = next_attempt_delay();
+      if (delay) {
+        _wake_cv.wait_for(lock, *delay, wake_condition);
+      } else {
+        _wake_cv.wait(lock, wake_condition);
+      }
+      _wake_requested = false;
+    }
+
+    if (!_running) { break; }
+
+    attempt_connect();
+  }
+}
+
+void ConnectionManager::attempt_connect() {
+  bool connected = _state == ConnectionState::Connected || try_connect();
+
+  std::optional<std::chrono::milliseconds> retry_delay;
+  {
+    std::lock_guard<std::mutex> lock(_wake_mutex);
+    if (connected) {
+      _settle_attempts_left = 0;
+    } else if (_settle_attempts_left > 0) {
+      --_settle_attempts_left;
+    }
+    if (connected || !_conn_method->open_failed()) {
+      _open_retry_delay = std::chrono::milliseconds(0);
+    } else if (_open_retry_delay.count() == 0) {
+      _open_retry_delay = SETTLE_INTERVAL;
+    } else {
+      _open_retry_delay = std::min(2 * _open_retry_delay, _connect_retry_interval.load());
+    }
+    if (_open_retry_delay.count() > 0) {
+      retry_delay = next_attempt_delay();
+    }
+  }
+  // The timer computed its next deadline before this attempt ran and may have parked
+  if (_context->reactor && retry_delay) {
+    _context->reactor->reschedule_timer(_connect_timer, Reactor::Clock::now() + *retry_delay);
+  }
+}
+
+void ConnectionManager::on_hotplug_event(const HotplugEvent& event) {
+  if (event.action == HotplugAction::Removed) {
+    // The connected device, if it was this one, reports a read error on its own
+    return;
+  }
+  if (_state == ConnectionState::Connected) {
+    return;
+  }
+  if (event.action == HotplugAction::Added) {
+    std::lock_guard<std::mutex> lock(_wake_mutex);
+    _settle_attempts_left = SETTLE_ATTEMPTS;
+  }
+  request_attempt();
+}
+
+void ConnectionManager::request_attempt() {
+  if (_context->reactor) {
+    _context->reactor->reschedule_timer(_connect_timer, Reactor::Clock::now());
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(_wake_mutex);
+    _wake_requested = true;
+  }
+  _wake_cv.notify_all();
+}
+
+std::optional<std::chrono::milliseconds> ConnectionManager::next_attempt_delay() {
+  if (_settle_attempts_left > 0) {
+    return SETTLE_INTERVAL;
+  }
+  if (_context->hotplug_monitor && _context->hotplug_monitor->is_available()) {
+    if (_open_retry_delay.count() > 0) {
+      return _open_retry_delay;
     }
+    return std::nullopt;
   }
+  return _connect_retry_interval.load();
 }
 
 void ConnectionManager::disconnect() {
@@ -102,15 +250,24 @@ void ConnectionManager::disconnect() {
     return;
   }
 
+  std::optional<HotplugEvent> released;
   {
     std::lock_guard<std::mutex> lock(_mutex);
     if (_device) {
-      _context->logger->log("Disconnecting from SpaceMouse device: " + _device->get_name());
+      _context->logger->log(LogLevel::Info, "Disconnecting from SpaceMouse device: ", _device->get_name());
+      released = HotplugEvent{ HotplugAction::Released, _device->path, _device->config.vid, _device->config.pid };
       _context->hid_backend->close(_device);
     }
     _device = nullptr;
   }
+  _disconnects.fetch_add(1, std::memory_order_relaxed);
+  _lost_time.store(std::chrono::steady_clock::now(), std::memory_order_relaxed);
   change_state(ConnectionState::Disconnected);
+
+  // Lets drivers waiting for this device try to claim it
+  if (released && _context->hotplug_monitor) {
+    _context->hotplug_monitor->notify(*released);
+  }
 }
 
 ConnectionState ConnectionManager::get_state() const {
@@ -140,6 +297,17 @@ void ConnectionManager::set_connect_retry_interval(std::chrono::milliseconds int
   _connect_retry_interval = interval;
 }
 
+void ConnectionManager::read_counters(DriverCounters& counters) const {
+  counters.connect_attempts = _connect_attempts.load(std::memory_order_relaxed);
+  counters.connects = _connects.load(std::memory_order_relaxed);
+  counters.disconnects = _disconnects.load(std::memory_order_relaxed);
+  counters.reconnects = _reconnects.load(std::memory_order_relaxed);
+  counters.total_reconnect_time =
+    std::chrono::nanoseconds(_total_reconnect_ns.load(std::memory_order_relaxed));
+  counters.max_reconnect_time =
+    std::chrono::nanoseconds(_max_reconnect_ns.load(std::memory_order_relaxed));
+}
+
 void ConnectionManager::change_state(ConnectionState new_state) {
   if (_state == new_state) {
     return;
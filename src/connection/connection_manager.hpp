@@ -23,10 +23,17 @@
 #include <functional>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
 
 #include "driver/driver_context.hpp"
 #include "connection/connection_method.hpp"
+#include "connection/hotplug_monitor.hpp"
+#include "reactor/reactor.hpp"
+#include "reactor/worker_pool.hpp"
 #include "spacemouse_driver/connection_state.hpp"
+#include "spacemouse_driver/statistics.hpp"
 
 namespace spacemouse_driver {
 
@@ -56,6 +63,9 @@ public:
   // Config
   void set_connect_retry_interval(std::chrono::milliseconds interval);
 
+  // Fills the counters owned by the connection manager
+  void read_counters(DriverCounters& counters) const;
+
 private:
   std::shared_ptr<DriverContext> _context;
   std::shared_ptr<ConnectionMethod> _conn_method;
@@ -65,12 +75,34 @@ private:
 
   // Connection management
   bool try_connect();
+  void attempt_connect();
 
   // Connection thread management
   std::atomic_bool _running;
   std::thread _connect_thread;
   void connect_loop();
 
+  // Shared reactor mode: retry timer posting connection attempts to the worker pool
+  Reactor::TimerId _connect_timer;
+  std::unique_ptr<SerialTask> _connect_task;
+
+  // Attempts are triggered by hotplug events, the retry interval is only used without them.
+  // After a device shows up a few quick attempts cover udev still setting its permissions. A
+  // device that is present but cannot be opened sends no further event, it is retried with a
+  // delay doubling from the settle interval up to the retry interval.
+  static constexpr int SETTLE_ATTEMPTS = 5;
+  static constexpr std::chrono::milliseconds SETTLE_INTERVAL{ 100 };
+  HotplugMonitor::ListenerId _hotplug_listener;
+  std::mutex _wake_mutex;
+  std::condition_variable _wake_cv;
+  bool _wake_requested;
+  int _settle_attempts_left;
+  std::chrono::milliseconds _open_retry_delay;  // Zero unless the last attempt failed to open a device
+  void on_hotplug_event(const HotplugEvent& event);
+  void request_attempt();
+  // Caller holds _wake_mutex, std::nullopt means waiting for a hotplug event
+  std::optional<std::chrono::milliseconds> next_attempt_delay();
+
   // Config
   std::atomic<std::chrono::milliseconds> _connect_retry_interval{ std::chrono::milliseconds(1000) };
 
@@ -80,6 +112,15 @@ private:
   // State changes
   void change_state(ConnectionState new_state);
   void notify_state_change();
+
+  // Counters, the reconnect time runs from losing a device to connecting again
+  std::atomic<uint64_t> _connect_attempts;
+  std::atomic<uint64_t> _connects;
+  std::atomic<uint64_t> _disconnects;
+  std::atomic<uint64_t> _reconnects;
+  std::atomic<uint64_t> _total_reconnect_ns;
+  std::atomic<uint64_t> _max_reconnect_ns;
+  std::atomic<std::chrono::steady_clock::time_point> _lost_time;  // Epoch while connected or stopped
 };
 
 }  // namespace spacemouse_driver
@@ -16,11 +16,8 @@
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
  */
 
-#include <algorithm>
-#include <iterator>
 #include <string>
 #include <vector>
-#include <utility>
 
 #include "connection/connection_method.hpp"
 #include "driver/driver_context.hpp"
@@ -28,89 +25,88 @@
 
 namespace spacemouse_driver {
 
+void ConnectionMethod::record_open_failure(const DriverContext& context, const std::string& path) {
+  // A device held by another driver is announced once it is released, there is nothing to retry
+  if (!context.hid_backend->is_claimed(path)) {
+    _open_failed = true;
+  }
+}
+
 ModelListConnectionMethod::ModelListConnectionMethod(const std::vector<Model>& model_list)
-: _model_list(model_list) { }
+: _model_list(model_list),
+  _missing_models_log(REPEATED_LOG_INTERVAL),
+  _not_found_log(REPEATED_LOG_INTERVAL) { }
 
 std::shared_ptr<DeviceHandle> ModelListConnectionMethod::connect(
   std::shared_ptr<DriverContext> context) {
+  _open_failed = false;
   if (_model_list.empty()) {
-    context->logger->error("No preferred models specified for device connection.");
-    return nullptr;
-  }
-  auto devs = context->hid_backend->enumerate();
-  std::vector<std::pair<DeviceInfo, int>> candidates;
-  for (const auto& dev : devs) {
-    auto device = DeviceRegistry::get(dev.vid, dev.pid);
-    if (!device) { continue; }
-    if (device->interface && device->interface != dev.interface) { continue; }
-
-    auto it = std::find(_model_list.begin(), _model_list.end(), device->model);
-    if (it == _model_list.end()) { continue; }
-
-    int priority = static_cast<int>(std::distance(_model_list.begin(), it));
-    candidates.emplace_back(dev, priority);
-  }
-  if (candidates.empty()) {
-    context->logger->log("No listed SpaceMouse devices found.");
+    _missing_models_log.log(*context->logger, LogLevel::Error, "No preferred models specified for device connection.");
     return nullptr;
   }
-  std::sort(
-    candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
-      return a.second < b.second;
-    });
-  std::shared_ptr<DeviceHandle> result = nullptr;
-  for (const auto& [dev, priority] : candidates) {
-    if (!result) {
-      result = context->hid_backend->open(dev.path, dev.vid, dev.pid);
-      if (result) {
-        continue;
+  auto snapshot = context->hid_backend->enumerate();
+  bool found = false;
+  // Walking the list in order yields the candidates already sorted by preference
+  for (const auto& model : _model_list) {
+    for (const auto& config : DeviceRegistry::DEVICES) {
+      if (config.model != model) { continue; }
+      for (const auto& dev : snapshot->find(config.vid, config.pid)) {
+        if (config.interface && config.interface != dev.interface) { continue; }
+        found = true;
+        auto device_handle = context->hid_backend->open(dev.path, dev.vid, dev.pid);
+        if (device_handle) {
+          return device_handle;
+        }
+        record_open_failure(*context, dev.path);
       }
     }
   }
-  return result;
+  if (!found) {
+    _not_found_log.log(*context->logger, LogLevel::Info, "No listed SpaceMouse devices found.");
+  }
+  return nullptr;
 }
 
 PathConnectionMethod::PathConnectionMethod(const std::string& path)
-: _path(path) { }
+: _path(path),
+  _not_found_log(REPEATED_LOG_INTERVAL),
+  _open_failed_log(REPEATED_LOG_INTERVAL) { }
 
 std::shared_ptr<DeviceHandle> PathConnectionMethod::connect(std::shared_ptr<DriverContext> context) {
-  auto devs = context->hid_backend->enumerate();
-  for (const auto& dev : devs) {
-    if (dev.path == _path) {
-      auto device = DeviceRegistry::get(dev.vid, dev.pid);
-      if (!device) {
-        context->logger->debug(
-          "Device at path " + _path +
-          " is not a supported SpaceMouse device.");
-        return nullptr;
-      }
-      auto device_handle = context->hid_backend->open(dev.path, dev.vid, dev.pid);
-      if (!device_handle) {
-        context->logger->error("Failed to open device at path: " + _path);
-        return nullptr;
-      }
-      return device_handle;
-    }
+  _open_failed = false;
+  auto snapshot = context->hid_backend->enumerate();
+  const DeviceInfo* dev = snapshot->find(_path);
+  if (!dev) {
+    _not_found_log.log(*context->logger, LogLevel::Debug, "No supported SpaceMouse device found at path: ", _path);
+    return nullptr;
   }
-  context->logger->debug("No device found at path: " + _path);
-  return nullptr;
+  auto device_handle = context->hid_backend->open(dev->path, dev->vid, dev->pid);
+  if (!device_handle) {
+    _open_failed_log.log(*context->logger, LogLevel::Error, "Failed to open device at path: ", _path);
+    record_open_failure(*context, dev->path);
+    return nullptr;
+  }
+  return device_handle;
 }
 
-AnyModelConnectionMethod::AnyModelConnectionMethod() = default;
+AnyModelConnectionMethod::AnyModelConnectionMethod()
+: _not_found_log(REPEATED_LOG_INTERVAL) { }
 
 std::shared_ptr<DeviceHandle> AnyModelConnectionMethod::connect(
   std::shared_ptr<DriverContext> context) {
-  auto devs = context->hid_backend->enumerate();
-  for (const auto& dev : devs) {
-    auto device = DeviceRegistry::get(dev.vid, dev.pid);
-    if (!device) { continue; }
-    if (device->interface && device->interface != dev.interface) { continue; }
-    auto device_handle = context->hid_backend->open(dev.path, dev.vid, dev.pid);
-    if (device_handle) {
-      return device_handle;
+  _open_failed = false;
+  auto snapshot = context->hid_backend->enumerate();
+  for (const auto& config : DeviceRegistry::DEVICES) {
+    for (const auto& dev : snapshot->find(config.vid, config.pid)) {
+      if (config.interface && config.interface != dev.interface) { continue; }
+      auto device_handle = context->hid_backend->open(dev.path, dev.vid, dev.pid);
+      if (device_handle) {
+        return device_handle;
+      }
+      record_open_failure(*context, dev.path);
     }
   }
-  context->logger->debug("No SpaceMouse devices found.");
+  _not_found_log.log(*context->logger, LogLevel::Debug, "No SpaceMouse devices found.");
   return nullptr;
 }
 
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -27,6 +28,7 @@
 
 #include "types/device_types.hpp"
 #include "driver/driver_context.hpp"
+#include "util/log_rate_limiter.hpp"
 
 namespace spacemouse_driver {
 
@@ -35,6 +37,19 @@ class ConnectionMethod
 public:
   virtual std::shared_ptr<DeviceHandle> connect(std::shared_ptr<DriverContext> context) = 0;
   virtual ~ConnectionMethod() = default;
+
+  // Set when the last connect() found a matching device no other driver holds but could not open
+  // it, e.g. before udev applied its permissions or while another process holds it
+  bool open_failed() const {
+    return _open_failed;
+  }
+
+protected:
+  // connect() is retried while no device is present, its failures are logged once per interval
+  static constexpr std::chrono::seconds REPEATED_LOG_INTERVAL{ 30 };
+
+  bool _open_failed = false;
+  void record_open_failure(const DriverContext& context, const std::string& path);
 };
 
 class ModelListConnectionMethod : public ConnectionMethod
@@ -45,6 +60,8 @@ public:
 
 private:
   std::vector<Model> _model_list;
+  LogRateLimiter _missing_models_log;
+  LogRateLimiter _not_found_log;
 };
 
 class PathConnectionMethod : public ConnectionMethod
@@ -55,6 +72,8 @@ public:
 
 private:
   std::string _path;
+  LogRateLimiter _not_found_log;
+  LogRateLimiter _open_failed_log;
 };
 
 class AnyModelConnectionMethod : public ConnectionMethod
@@ -62,6 +81,9 @@ class AnyModelConnectionMethod : public ConnectionMethod
 public:
   AnyModelConnectionMethod();
   std::shared_ptr<DeviceHandle> connect(std::shared_ptr<DriverContext> context) override;
+
+private:
+  LogRateLimiter _not_found_log;
 };
 
 }  // namespace spacemouse_driver
@@ -18,12 +18,14 @@
 
 #include "connection/hid_backend.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 #include <vector>
 #include <string>
 #include <memory>
 
 #include "device/device_registry.hpp"
+#include "device/report_parser.hpp"
 
 namespace spacemouse_driver {
 
@@ -41,13 +43,39 @@ HidBackend::~HidBackend() {
   }
 }
 
-std::vector<DeviceInfo> HidBackend::enumerate() {
-  hid_device_info* devs = hid_enumerate(0x0, 0x0);
+std::shared_ptr<const DeviceSnapshot> HidBackend::enumerate() {
+  std::lock_guard<std::mutex> lock(_snapshot_mutex);
+  auto now = std::chrono::steady_clock::now();
+  if (!_snapshot || now - _snapshot_time > SNAPSHOT_TTL) {
+    _snapshot = std::make_shared<const DeviceSnapshot>(scan_supported());
+    _snapshot_time = now;
+  }
+  return _snapshot;
+}
+
+void HidBackend::invalidate_enumeration() {
+  std::lock_guard<std::mutex> lock(_snapshot_mutex);
+  _snapshot = nullptr;
+}
+
+std::vector<DeviceInfo> HidBackend::scan_supported() {
   std::vector<DeviceInfo> devices;
-  for (hid_device_info* dev = devs; dev; dev = dev->next) {
-    devices.push_back({ dev->path, dev->vendor_id, dev->product_id, dev->interface_number });
+  std::vector<uint16_t> scanned_vids;
+  for (const auto& config : DeviceRegistry::DEVICES) {
+    if (std::find(scanned_vids.begin(), scanned_vids.end(), config.vid) != scanned_vids.end()) {
+      continue;
+    }
+    scanned_vids.push_back(config.vid);
+
+    hid_device_info* devs = hid_enumerate(config.vid, 0x0);
+    for (hid_device_info* dev = devs; dev; dev = dev->next) {
+      if (!DeviceRegistry::get(dev->vendor_id, dev->product_id)) {
+        continue;
+      }
+      devices.push_back({ dev->path, dev->vendor_id, dev->product_id, dev->interface_number });
+    }
+    hid_free_enumeration(devs);
   }
-  hid_free_enumeration(devs);
   return devices;
 }
 
@@ -67,13 +95,25 @@ std::shared_ptr<DeviceHandle> HidBackend::open(const std::string& path, uint16_t
     _shared_device_manager->release_path(path);
     return nullptr;
   }
-  return std::make_shared<DeviceHandle>(hid_device, *config, path);
+  return std::make_shared<DeviceHandle>(hid_device, *config, get_report_parser(vid, pid), path);
+}
+
+bool HidBackend::is_claimed(const std::string& path) const {
+  return _shared_device_manager->is_claimed(path);
 }
 
 int HidBackend::read(std::shared_ptr<DeviceHandle>& handle, uint8_t* buf, size_t len) {
   return hid_read_timeout(handle->hid_handle, buf, len, 100);
 }
 
+int HidBackend::try_read(std::shared_ptr<DeviceHandle>& handle, uint8_t* buf, size_t len) {
+  return hid_read_timeout(handle->hid_handle, buf, len, 0);
+}
+
+void HidBackend::interrupt(const std::shared_ptr<DeviceHandle>&) noexcept {
+  // hid_read_timeout() returns on its own within the read timeout
+}
+
 void HidBackend::close(std::shared_ptr<DeviceHandle>& handle) noexcept{
   if (handle->hid_handle) {
     hid_close(handle->hid_handle);
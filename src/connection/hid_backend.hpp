@@ -24,24 +24,44 @@
 #include <string>
 #include <memory>
 #include <stdexcept>
+#include <chrono>
+#include <mutex>
 
 #include "types/device_types.hpp"
 #include "device/shared_device_manager.hpp"
+#include "device/device_snapshot.hpp"
 
 namespace spacemouse_driver {
 
 class HidBackend
 {
-private:
+protected:
   std::shared_ptr<SharedDeviceManager> _shared_device_manager;
 
 public:
   explicit HidBackend(std::shared_ptr<SharedDeviceManager> shared_device_manager);
   virtual ~HidBackend();
-  virtual std::vector<DeviceInfo> enumerate();
+  // Supported devices only. The snapshot is shared by all drivers and rebuilt once it is older
+  // than SNAPSHOT_TTL or has been invalidated.
+  virtual std::shared_ptr<const DeviceSnapshot> enumerate();
+  void invalidate_enumeration();
   virtual std::shared_ptr<DeviceHandle> open(const std::string& path, uint16_t vid, uint16_t pid);
+  // Opened by another driver of the manager, which reports a Released hotplug event on closing it
+  bool is_claimed(const std::string& path) const;
   virtual int read(std::shared_ptr<DeviceHandle>& handle, uint8_t* buf, size_t len);
+  // Returns 0 right away when no report is queued
+  virtual int try_read(std::shared_ptr<DeviceHandle>& handle, uint8_t* buf, size_t len);
+  // Wakes up a thread blocked in read() on this handle, which then returns 0
+  virtual void interrupt(const std::shared_ptr<DeviceHandle>& handle) noexcept;
   virtual void close(std::shared_ptr<DeviceHandle>& handle) noexcept;
+
+private:
+  static constexpr std::chrono::milliseconds SNAPSHOT_TTL{ 250 };
+  std::mutex _snapshot_mutex;
+  std::shared_ptr<const DeviceSnapshot> _snapshot;
+  std::chrono::steady_clock::time_point _snapshot_time;
+
+  std::vector<DeviceInfo> scan_supported();
 };
 
 }  // namespace spacemouse_driver
@@ -0,0 +1,131 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "connection/hidraw_backend.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "device/device_registry.hpp"
+#include "device/report_parser.hpp"
+
+namespace spacemouse_driver {
+
+HidrawBackend::HidrawBackend(std::shared_ptr<SharedDeviceManager> shared_device_manager)
+: HidBackend(shared_device_manager) { }
+
+std::shared_ptr<DeviceHandle> HidrawBackend::open(const std::string& path, uint16_t vid, uint16_t pid) {
+  auto config = DeviceRegistry::get(vid, pid);
+  if (!config) {
+    return nullptr;
+  }
+  bool available = _shared_device_manager->claim_path(path);
+  if (!available) {
+    return nullptr;
+  }
+
+  int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  int wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+  bool ok = fd >= 0 && wake_fd >= 0 && epoll_fd >= 0;
+  if (ok) {
+    epoll_event ev{ };
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    ok = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+    ev.data.fd = wake_fd;
+    ok = ok && epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev) == 0;
+  }
+  if (!ok) {
+    for (int to_close : { fd, wake_fd, epoll_fd }) {
+      if (to_close >= 0) { ::close(to_close); }
+    }
+    _shared_device_manager->release_path(path);
+    return nullptr;
+  }
+  return std::make_shared<DeviceHandle>(
+    fd, wake_fd, epoll_fd, *config, get_report_parser(vid, pid),
+    path);
+}
+
+int HidrawBackend::read(std::shared_ptr<DeviceHandle>& handle, uint8_t* buf, size_t len) {
+  while (true) {
+    int res = try_read(handle, buf, len);
+    if (res != 0) {
+      return res;
+    }
+
+    epoll_event events[2];
+    int count = epoll_wait(handle->epoll_fd, events, 2, -1);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    for (int i = 0; i < count; ++i) {
+      if (events[i].data.fd == handle->wake_fd) {
+        uint64_t value;
+        [[maybe_unused]] ssize_t drained = ::read(handle->wake_fd, &value, sizeof(value));
+        return 0;
+      }
+    }
+    // Device is readable or hung up, the next read() reports which one
+  }
+}
+
+int HidrawBackend::try_read(std::shared_ptr<DeviceHandle>& handle, uint8_t* buf, size_t len) {
+  while (true) {
+    ssize_t res = ::read(handle->fd, buf, len);
+    if (res >= 0) {
+      return static_cast<int>(res);
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    return errno == EAGAIN ? 0 : -1;
+  }
+}
+
+void HidrawBackend::interrupt(const std::shared_ptr<DeviceHandle>& handle) noexcept {
+  if (handle && handle->wake_fd >= 0) {
+    uint64_t value = 1;
+    [[maybe_unused]] ssize_t written = ::write(handle->wake_fd, &value, sizeof(value));
+  }
+}
+
+void HidrawBackend::close(std::shared_ptr<DeviceHandle>& handle) noexcept {
+  if (handle->fd >= 0) {
+    ::close(handle->epoll_fd);
+    ::close(handle->wake_fd);
+    ::close(handle->fd);
+    handle->fd = handle->wake_fd = handle->epoll_fd = -1;
+    _shared_device_manager->release_path(handle->path);
+    handle.reset();
+  }
+}
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,42 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "connection/hid_backend.hpp"
+
+namespace spacemouse_driver {
+
+// Talks to /dev/hidrawN directly. Enumeration still goes through hidapi, but every opened
+// device gets a non-blocking descriptor watched by its own epoll instance together with an
+// eventfd, so read() sleeps until the kernel has a report ready or interrupt() is called.
+class HidrawBackend : public HidBackend
+{
+public:
+  explicit HidrawBackend(std::shared_ptr<SharedDeviceManager> shared_device_manager);
+  std::shared_ptr<DeviceHandle> open(const std::string& path, uint16_t vid, uint16_t pid) override;
+  int read(std::shared_ptr<DeviceHandle>& handle, uint8_t* buf, size_t len) override;
+  int try_read(std::shared_ptr<DeviceHandle>& handle, uint8_t* buf, size_t len) override;
+  void interrupt(const std::shared_ptr<DeviceHandle>& handle) noexcept override;
+  void close(std::shared_ptr<DeviceHandle>& handle) noexcept override;
+};
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,231 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "connection/hotplug_monitor.hpp"
+
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "device/device_registry.hpp"
+
+namespace spacemouse_driver {
+
+HotplugMonitor::HotplugMonitor()
+: _socket_fd(socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT)),
+  _wake_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+  _running(false),
+  _reactor(nullptr),
+  _next_listener_id(1) {
+  sockaddr_nl addr{ };
+  addr.nl_family = AF_NETLINK;
+  addr.nl_groups = 1;  // Kernel uevent multicast group
+  bool ok = _socket_fd >= 0 && _wake_fd >= 0 &&
+    bind(_socket_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+  if (!ok) {
+    if (_socket_fd >= 0) { ::close(_socket_fd); }
+    if (_wake_fd >= 0) { ::close(_wake_fd); }
+    _socket_fd = _wake_fd = -1;
+  }
+}
+
+HotplugMonitor::~HotplugMonitor() {
+  stop();
+  if (_socket_fd >= 0) { ::close(_socket_fd); }
+  if (_wake_fd >= 0) { ::close(_wake_fd); }
+}
+
+bool HotplugMonitor::is_available() const {
+  return _socket_fd >= 0;
+}
+
+void HotplugMonitor::start(Reactor* reactor) {
+  if (_running || !is_available()) {
+    return;
+  }
+  _running = true;
+  _reactor = reactor;
+  if (_reactor) {
+    _reactor->add_fd(
+      _socket_fd, [this](uint32_t) {
+        receive_events();
+      });
+  } else {
+    _monitor_thread = std::thread(&HotplugMonitor::monitor_loop, this);
+  }
+}
+
+void HotplugMonitor::stop() {
+  if (!_running) {
+    return;
+  }
+  _running = false;
+  if (_reactor) {
+    _reactor->remove_fd(_socket_fd);
+    _reactor = nullptr;
+  }
+  uint64_t value = 1;
+  [[maybe_unused]] ssize_t written = ::write(_wake_fd, &value, sizeof(value));
+  if (_monitor_thread.joinable()) {
+    _monitor_thread.join();
+  }
+}
+
+HotplugMonitor::ListenerId HotplugMonitor::subscribe(Listener listener) {
+  std::lock_guard<std::mutex> lock(_listener_mutex);
+  ListenerId id = _next_listener_id++;
+  _listeners[id] = std::move(listener);
+  return id;
+}
+
+void HotplugMonitor::unsubscribe(ListenerId id) {
+  std::lock_guard<std::mutex> lock(_listener_mutex);
+  _listeners.erase(id);
+}
+
+void HotplugMonitor::notify(const HotplugEvent& event) {
+  // Listeners are called under the lock so unsubscribe() never returns while one is running
+  std::lock_guard<std::mutex> lock(_listener_mutex);
+  for (const auto& [id, listener] : _listeners) {
+    listener(event);
+  }
+}
+
+void HotplugMonitor::monitor_loop() {
+  pollfd fds[2] = {
+    { _socket_fd, POLLIN, 0 },
+    { _wake_fd, POLLIN, 0 },
+  };
+
+  while (_running) {
+    int res = poll(fds, 2, -1);
+    if (res < 0 && errno != EINTR) {
+      break;
+    }
+    if (fds[0].revents & POLLIN) {
+      receive_events();
+    }
+  }
+}
+
+void HotplugMonitor::receive_events() {
+  char buf[4096];
+
+  while (true) {
+    sockaddr_nl sender{ };
+    socklen_t sender_len = sizeof(sender);
+    ssize_t len = recvfrom(
+      _socket_fd, buf, sizeof(buf), 0,
+      reinterpret_cast<sockaddr*>(&sender), &sender_len);
+    if (len < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // EAGAIN once drained, ENOBUFS when the kernel dropped events which polling does not need
+      return;
+    }
+    // Only the kernel itself may send uevents on this group
+    if (sender.nl_pid != 0) {
+      continue;
+    }
+
+    auto event = parse_uevent(buf, static_cast<size_t>(len));
+    if (event) {
+      notify(*event);
+    }
+  }
+}
+
+std::optional<HotplugEvent> HotplugMonitor::parse_uevent(const char* data, size_t length) {
+  // "action@devpath" header followed by NUL separated KEY=VALUE pairs
+  std::string_view action;
+  std::string_view devpath;
+  std::string_view subsystem;
+  std::string_view devname;
+
+  size_t pos = 0;
+  while (pos < length) {
+    std::string_view field(data + pos, strnlen(data + pos, length - pos));
+    pos += field.size() + 1;
+
+    auto separator = field.find('=');
+    if (separator == std::string_view::npos) {
+      continue;
+    }
+    auto key = field.substr(0, separator);
+    auto value = field.substr(separator + 1);
+    if (key == "ACTION") {
+      action = value;
+    } else if (key == "DEVPATH") {
+      devpath = value;
+    } else if (key == "SUBSYSTEM") {
+      subsystem = value;
+    } else if (key == "DEVNAME") {
+      devname = value;
+    }
+  }
+
+  if (subsystem != "hidraw" || devname.empty()) {
+    return std::nullopt;
+  }
+
+  HotplugEvent event{ };
+  if (action == "add") {
+    event.action = HotplugAction::Added;
+  } else if (action == "remove") {
+    event.action = HotplugAction::Removed;
+  } else {
+    return std::nullopt;
+  }
+
+  // .../0003:256F:C633.0004/hidraw/hidraw3, the parent HID device is named bus:vid:pid.instance
+  auto hidraw_dir = devpath.rfind("/hidraw/");
+  if (hidraw_dir == std::string_view::npos) {
+    return std::nullopt;
+  }
+  auto parent_start = devpath.rfind('/', hidraw_dir - 1);
+  if (parent_start == std::string_view::npos) {
+    return std::nullopt;
+  }
+  std::string parent(devpath.substr(parent_start + 1, hidraw_dir - parent_start - 1));
+  unsigned int bus;
+  unsigned int vid;
+  unsigned int pid;
+  if (std::sscanf(parent.c_str(), "%x:%x:%x.", &bus, &vid, &pid) != 3) {
+    return std::nullopt;
+  }
+  event.vid = static_cast<uint16_t>(vid);
+  event.pid = static_cast<uint16_t>(pid);
+  if (!DeviceRegistry::get(event.vid, event.pid)) {
+    return std::nullopt;
+  }
+
+  event.path = "/dev/" + std::string(devname);
+  return event;
+}
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,90 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "reactor/reactor.hpp"
+
+namespace spacemouse_driver {
+
+enum class HotplugAction
+{
+  Added,     // Kernel created a hidraw node for a supported device
+  Removed,   // Kernel removed a hidraw node of a supported device
+  Released,  // Another driver closed the device, it can be claimed again
+};
+
+struct HotplugEvent {
+  HotplugAction action;
+  std::string path;
+  uint16_t vid;
+  uint16_t pid;
+};
+
+// Listens to kernel uevents on a NETLINK_KOBJECT_UEVENT socket and forwards the ones concerning
+// hidraw nodes of devices listed in DeviceRegistry. Listeners are called from the monitor thread,
+// or from the reactor thread in shared reactor mode, and must return quickly.
+class HotplugMonitor
+{
+public:
+  using Listener = std::function<void(const HotplugEvent&)>;
+  using ListenerId = uint64_t;
+
+  HotplugMonitor();
+  ~HotplugMonitor();
+
+  // False when the netlink socket could not be opened, callers should poll instead
+  bool is_available() const;
+
+  // Thread control, events are read on the reactor when one is given, on an own thread otherwise
+  void start(Reactor* reactor);
+  void stop();
+
+  ListenerId subscribe(Listener listener);
+  void unsubscribe(ListenerId id);
+
+  // Delivers an event to all listeners, also used for events that do not come from the kernel
+  void notify(const HotplugEvent& event);
+
+private:
+  int _socket_fd;
+  int _wake_fd;
+
+  std::atomic_bool _running;
+  std::thread _monitor_thread;
+  Reactor* _reactor;
+
+  std::mutex _listener_mutex;
+  std::map<ListenerId, Listener> _listeners;
+  ListenerId _next_listener_id;
+
+  void monitor_loop();
+  void receive_events();
+  static std::optional<HotplugEvent> parse_uevent(const char* data, size_t length);
+};
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,66 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "types/device_types.hpp"
+
+namespace spacemouse_driver {
+
+// Immutable result of one enumeration, indexed by VID/PID and by path
+class DeviceSnapshot
+{
+public:
+  explicit DeviceSnapshot(const std::vector<DeviceInfo>& devices) {
+    for (const auto& dev : devices) {
+      _by_id[key(dev.vid, dev.pid)].push_back(dev);
+      _by_path.emplace(dev.path, dev);
+    }
+  }
+
+  // Devices in enumeration order
+  const std::vector<DeviceInfo>& find(uint16_t vid, uint16_t pid) const {
+    static const std::vector<DeviceInfo> none;
+    auto it = _by_id.find(key(vid, pid));
+    return it != _by_id.end() ? it->second : none;
+  }
+
+  const DeviceInfo* find(const std::string& path) const {
+    auto it = _by_path.find(path);
+    return it != _by_path.end() ? &it->second : nullptr;
+  }
+
+  bool empty() const {
+    return _by_path.empty();
+  }
+
+private:
+  std::unordered_map<uint32_t, std::vector<DeviceInfo>> _by_id;
+  std::unordered_map<std::string, DeviceInfo> _by_path;
+
+  static uint32_t key(uint16_t vid, uint16_t pid) {
+    return (static_cast<uint32_t>(vid) << 16) | pid;
+  }
+};
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,256 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <variant>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "types/device_types.hpp"
+#include "device/device_registry.hpp"
+
+namespace spacemouse_driver {
+
+namespace report_parser {
+
+// Mappings of a single report ID, grouped so decoding never looks at mappings of other reports
+struct ReportPlan {
+  uint8_t report_id = 0;
+
+  size_t axis_count = 0;
+  std::array<AxisMapping, AxisCount> axes{ };
+  std::array<uint8_t, AxisCount> axis_index{ };
+
+  // Set when all axes are consecutive little endian words in Axis order starting at axis_offset,
+  // they are then decoded as one block with inversion applied through a lane mask
+  bool contiguous_axes = false;
+  uint8_t axis_offset = 0;
+  std::array<uint16_t, 8> axis_invert_mask{ };  // One 128-bit vector, lanes past AxisCount stay 0
+
+  size_t bit_count = 0;
+  std::array<BitMaskMapping, ButtonCount> bits{ };
+  std::array<uint8_t, ButtonCount> bit_button_index{ };
+
+  // Byte code buttons are all released, then set by one pass over the report through code_table
+  ButtonMask code_mask = 0;
+  std::array<ButtonMask, 256> code_table{ };
+};
+
+constexpr size_t button_report_id(const ButtonMapping& mapping) {
+  return std::holds_alternative<BitMaskMapping>(mapping) ?
+         std::get<BitMaskMapping>(mapping).report_id :
+         std::get<ByteCodeMapping>(mapping).report_id;
+}
+
+// Distinct report IDs, in order of first appearance in the config
+constexpr std::array<int, AxisCount + ButtonCount> report_ids(const DeviceConfig& config) {
+  std::array<int, AxisCount + ButtonCount> ids{ };
+  size_t count = 0;
+  auto add = [&](int id) {
+      for (size_t i = 0; i < count; ++i) {
+        if (ids[i] == id) { return; }
+      }
+      ids[count++] = id;
+    };
+  for (const auto& mapping : config.axis_mappings) {
+    add(mapping.report_id);
+  }
+  for (const auto& mapping : config.button_mappings) {
+    if (mapping) { add(static_cast<int>(button_report_id(*mapping))); }
+  }
+  for (size_t i = count; i < ids.size(); ++i) {
+    ids[i] = -1;
+  }
+  return ids;
+}
+
+constexpr size_t report_count(const DeviceConfig& config) {
+  size_t count = 0;
+  for (int id : report_ids(config)) {
+    if (id >= 0) { ++count; }
+  }
+  return count;
+}
+
+template<size_t ReportCount>
+constexpr std::array<ReportPlan, ReportCount> make_plans(const DeviceConfig& config) {
+  std::array<ReportPlan, ReportCount> plans{ };
+  auto ids = report_ids(config);
+  for (size_t r = 0; r < ReportCount; ++r) {
+    ReportPlan& plan = plans[r];
+    plan.report_id = static_cast<uint8_t>(ids[r]);
+
+    for (size_t i = 0; i < AxisCount; ++i) {
+      const auto& mapping = config.axis_mappings[i];
+      if (mapping.report_id != plan.report_id) { continue; }
+      plan.axes[plan.axis_count] = mapping;
+      plan.axis_index[plan.axis_count] = static_cast<uint8_t>(*magic_enum::enum_index(mapping.axis));
+      ++plan.axis_count;
+    }
+
+    plan.contiguous_axes = plan.axis_count == AxisCount;
+    plan.axis_offset = plan.axes[0].byte_low_idx;
+    for (size_t i = 0; i < plan.axis_count; ++i) {
+      const auto& mapping = plan.axes[i];
+      size_t low = plan.axis_offset + 2 * plan.axis_index[i];
+      if (mapping.byte_low_idx != low || mapping.byte_high_idx != low + 1) {
+        plan.contiguous_axes = false;
+      }
+      plan.axis_invert_mask[plan.axis_index[i]] = mapping.invert ? 0xFFFF : 0;
+    }
+
+    for (size_t i = 0; i < ButtonCount; ++i) {
+      const auto& mapping = config.button_mappings[i];
+      if (!mapping || button_report_id(*mapping) != plan.report_id) { continue; }
+      if (std::holds_alternative<BitMaskMapping>(*mapping)) {
+        plan.bits[plan.bit_count] = std::get<BitMaskMapping>(*mapping);
+        plan.bit_button_index[plan.bit_count] = static_cast<uint8_t>(i);
+        ++plan.bit_count;
+      } else {
+        plan.code_mask |= ButtonMask{ 1 } << i;
+        plan.code_table[std::get<ByteCodeMapping>(*mapping).code] |= ButtonMask{ 1 } << i;
+      }
+    }
+  }
+  return plans;
+}
+
+// Portable version of decode_axis_words()
+inline void decode_axis_words_scalar(
+  const uint8_t* data, const std::array<uint16_t, 8>& invert_mask,
+  std::array<int16_t, AxisCount>& out) {
+  for (size_t i = 0; i < AxisCount; ++i) {
+    uint16_t word = static_cast<uint16_t>(data[2 * i] | (data[2 * i + 1] << 8));
+    out[i] = static_cast<int16_t>(static_cast<uint16_t>((word ^ invert_mask[i]) - invert_mask[i]));
+  }
+}
+
+// Decodes AxisCount consecutive little endian words, negating the lanes set in invert_mask
+inline void decode_axis_words(
+  const uint8_t* data, const std::array<uint16_t, 8>& invert_mask,
+  std::array<int16_t, AxisCount>& out) {
+  static_assert(AxisCount == 6, "Axis words are loaded as one 8 and one 4 byte block");
+#if defined(__SSE2__)
+  // Exactly 12 bytes are loaded and stored, the report may end right after the last axis
+  int32_t tail;
+  std::memcpy(&tail, data + 8, sizeof(tail));
+  __m128i value = _mm_unpacklo_epi64(
+    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data)),
+    _mm_cvtsi32_si128(tail));
+  // Negation as (x ^ m) - m, which leaves lanes with a zero mask untouched
+  __m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(invert_mask.data()));
+  value = _mm_sub_epi16(_mm_xor_si128(value, lanes), lanes);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(out.data()), value);
+  tail = _mm_cvtsi128_si32(_mm_srli_si128(value, 8));
+  std::memcpy(out.data() + 4, &tail, sizeof(tail));
+#else
+  decode_axis_words_scalar(data, invert_mask, out);
+#endif
+}
+
+// Parser of the config at DeviceRegistry::DEVICES[ConfigIndex]. Report IDs, byte offsets and
+// lookup tables are compile time constants, so every report ID gets its own unrolled decoder.
+template<size_t ConfigIndex>
+class SpecializedParser
+{
+public:
+  static void parse(const uint8_t* data, size_t length, Input& frame) {
+    frame.stick.divisor = CONFIG.axis_div;
+    if (length > 0) {
+      dispatch(data, length, frame, std::make_index_sequence<PLANS.size()>{ });
+    }
+  }
+
+private:
+  static constexpr DeviceConfig CONFIG = DeviceRegistry::DEVICES[ConfigIndex];
+  static constexpr auto PLANS = make_plans<report_count(CONFIG)>(CONFIG);
+
+  template<size_t... R>
+  static void dispatch(const uint8_t* data, size_t length, Input& frame, std::index_sequence<R...>) {
+    (void)((data[0] == PLANS[R].report_id && (decode<R>(data, length, frame), true)) || ...);
+  }
+
+  template<size_t R>
+  static void decode(const uint8_t* data, size_t length, Input& frame) {
+    constexpr const ReportPlan& plan = PLANS[R];
+
+    if constexpr (plan.contiguous_axes) {
+      if (length >= plan.axis_offset + 2 * AxisCount) {
+        decode_axis_words(data + plan.axis_offset, plan.axis_invert_mask, frame.stick.raw);
+        decode_buttons<R>(data, length, frame);
+        return;
+      }
+    }
+
+    // Axes of a report that is too short are decoded one by one, as far as the data goes
+    for (size_t i = 0; i < plan.axis_count; ++i) {
+      auto raw_data = plan.axes[i].parse(data, length);
+      if (!raw_data) { continue; }
+      frame.stick.raw[plan.axis_index[i]] = *raw_data;
+    }
+    decode_buttons<R>(data, length, frame);
+  }
+
+  template<size_t R>
+  static void decode_buttons(const uint8_t* data, size_t length, Input& frame) {
+    constexpr const ReportPlan& plan = PLANS[R];
+
+    for (size_t i = 0; i < plan.bit_count; ++i) {
+      auto is_pressed = plan.bits[i].parse(data, length);
+      if (!is_pressed) { continue; }
+      frame.buttons.set(plan.bit_button_index[i], *is_pressed);
+    }
+
+    if constexpr (plan.code_mask != 0) {
+      ButtonMask pressed = 0;
+      for (size_t i = 1; i < length; ++i) {
+        pressed |= plan.code_table[data[i]];
+      }
+      frame.buttons.mask = (frame.buttons.mask & ~plan.code_mask) | pressed;
+    }
+  }
+};
+
+template<size_t... I>
+constexpr std::array<ReportParser, sizeof...(I)> make_parsers(std::index_sequence<I...>) {
+  return { &SpecializedParser<I>::parse ... };
+}
+
+inline constexpr auto PARSERS = make_parsers(std::make_index_sequence<DeviceRegistry::DEVICES.size()>{ });
+
+}  // namespace report_parser
+
+// Parser generated for a supported device, nullptr otherwise
+inline ReportParser get_report_parser(uint16_t vid, uint16_t pid) {
+  for (size_t i = 0; i < DeviceRegistry::DEVICES.size(); ++i) {
+    if (DeviceRegistry::DEVICES[i].vid == vid && DeviceRegistry::DEVICES[i].pid == pid) {
+      return report_parser::PARSERS[i];
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace spacemouse_driver
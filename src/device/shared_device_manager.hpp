@@ -42,6 +42,11 @@ public:
     _claimed_paths.erase(path);
   }
 
+  bool is_claimed(const std::string& path) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _claimed_paths.count(path) > 0;
+  }
+
 private:
   std::set<std::string> _claimed_paths;
   std::mutex _mutex;
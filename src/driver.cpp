@@ -22,6 +22,7 @@
 #include "connection/connection_manager.hpp"
 #include "input/input_processor.hpp"
 #include "input/callback_dispatcher.hpp"
+#include "driver/driver_diagnostics.hpp"
 
 namespace spacemouse_driver {
 
@@ -29,10 +30,11 @@ Driver::Driver(
   std::shared_ptr<DriverContext> context,
   std::shared_ptr<ConnectionMethod> conn_method)
 : _context(context),
-  _running(false) {
+  _running(false),
+  _diagnostics(std::make_unique<DriverDiagnostics>()) {
   _connection_manager = std::make_unique<ConnectionManager>(context, conn_method);
-  _input_processor = std::make_unique<InputProcessor>(context);
-  _callback_dispatcher = std::make_unique<CallbackDispatcher>(context);
+  _input_processor = std::make_unique<InputProcessor>(context, *_diagnostics);
+  _callback_dispatcher = std::make_unique<CallbackDispatcher>(context, *_input_processor, *_diagnostics);
 
   _connection_manager->set_state_change_callback(
     std::bind(
@@ -82,7 +84,33 @@ void Driver::stop() {
 }
 
 Input Driver::read_input() const {
-  return _input_processor->get_latest_input();
+  Input input;
+  _input_processor->get_latest_input(input);
+  return input;
+}
+
+uint64_t Driver::read_input(Input& input) const {
+  return _input_processor->get_latest_input(input);
+}
+
+InputHistoryRead Driver::read_input_since(
+  uint64_t sequence, Input* frames,
+  size_t max_frames) const {
+  return _input_processor->get_input_since(sequence, frames, max_frames);
+}
+
+uint64_t Driver::wait_for_input(
+  uint64_t last_sequence, std::chrono::milliseconds timeout,
+  Input& input) const {
+  return _input_processor->wait_for_input(last_sequence, timeout, input);
+}
+
+void Driver::register_input_callback(std::function<void(const Input&)> callback) {
+  _callback_dispatcher->register_input_callback(callback);
+}
+
+void Driver::delete_input_callback() {
+  _callback_dispatcher->delete_input_callback();
 }
 
 void Driver::register_stick_callback(std::function<void(StickInput)> callback) {
@@ -93,6 +121,32 @@ void Driver::register_button_callback(Button button, std::function<void(ButtonIn
   _callback_dispatcher->register_button_callback(button, callback);
 }
 
+void Driver::register_button_mask_callback(std::function<void(ButtonMask, ButtonMask)> callback) {
+  _callback_dispatcher->register_button_mask_callback(callback);
+}
+
+Subscription Driver::subscribe(
+  std::function<void(const Input&)> callback,
+  SubscriptionOptions options) {
+  return _callback_dispatcher->subscribe(callback, options);
+}
+
+void Driver::register_button_event_callback(std::function<void(const ButtonEvent&)> callback) {
+  _callback_dispatcher->register_button_event_callback(callback);
+}
+
+void Driver::delete_button_event_callback() {
+  _callback_dispatcher->delete_button_event_callback();
+}
+
+void Driver::register_motion_callback(std::function<void(const StickMotion&)> callback) {
+  _callback_dispatcher->register_motion_callback(callback);
+}
+
+void Driver::delete_motion_callback() {
+  _callback_dispatcher->delete_motion_callback();
+}
+
 void Driver::delete_stick_callback() {
   _callback_dispatcher->delete_stick_callback();
 }
@@ -101,10 +155,18 @@ void Driver::delete_button_callback(Button button) {
   _callback_dispatcher->delete_button_callback(button);
 }
 
-void Driver::set_callback_interval(std::chrono::milliseconds interval) {
+void Driver::delete_button_mask_callback() {
+  _callback_dispatcher->delete_button_mask_callback();
+}
+
+void Driver::set_callback_interval(std::chrono::microseconds interval) {
   _callback_dispatcher->set_callback_interval(interval);
 }
 
+void Driver::set_interval_coalescing(Coalescing coalescing) {
+  _callback_dispatcher->set_interval_coalescing(coalescing);
+}
+
 void Driver::set_connection_retry_interval(std::chrono::milliseconds interval) {
   _connection_manager->set_connect_retry_interval(interval);
 }
@@ -121,19 +183,48 @@ std::optional<Model> Driver::get_connected_model() const {
   return _connection_manager->get_connected_model();
 }
 
+JitterStats Driver::get_callback_jitter() const {
+  return _callback_dispatcher->get_jitter_stats();
+}
+
+DriverCounters Driver::get_counters() const {
+  DriverCounters counters{ };
+  _input_processor->read_counters(counters);
+  _callback_dispatcher->read_counters(counters);
+  _connection_manager->read_counters(counters);
+  return counters;
+}
+
+bool Driver::dump_trace(const std::string& path) const {
+  return _diagnostics->trace.dump(path);
+}
+
+LatencyStats Driver::get_latency_stats() const {
+  return _diagnostics->latency_stats();
+}
+
+void Driver::reset_latency_stats() {
+  _diagnostics->reset_latency_stats();
+}
+
 void Driver::on_connection_state_change(ConnectionState state, std::shared_ptr<DeviceHandle> device) {
   if (state == ConnectionState::Connected) {
+    _diagnostics->trace.record(TraceEvent::Connected);
     _input_processor->set_device(device);
   } else if (state == ConnectionState::Disconnected) {
-    _callback_dispatcher->process_input(Input{ });
+    _diagnostics->trace.record(TraceEvent::Disconnected);
+    // Dispatch the zeroed frame published on clear, so it carries a sequence and timestamp too
     _input_processor->clear_device();
+    Input cleared;
+    _input_processor->get_latest_input(cleared);
+    _callback_dispatcher->process_input(cleared);
   }
 }
 
 void Driver::on_new_input(const Input& input, bool error) {
   // Input error = device disconnected
   if (error && _connection_manager->get_state() == ConnectionState::Connected) {
-    _context->logger->debug("Failed to read input data from the device, disconnecting");
+    _context->logger->log(LogLevel::Debug, "Failed to read input data from the device, disconnecting");
     _connection_manager->disconnect();
     return;
   }
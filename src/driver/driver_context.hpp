@@ -22,6 +22,9 @@
 #include <utility>
 
 #include "connection/hid_backend.hpp"
+#include "connection/hotplug_monitor.hpp"
+#include "reactor/reactor.hpp"
+#include "reactor/worker_pool.hpp"
 #include "spacemouse_driver/logger.hpp"
 
 namespace spacemouse_driver {
@@ -29,12 +32,22 @@ namespace spacemouse_driver {
 struct DriverContext {
   std::unique_ptr<HidBackend> hid_backend;
   std::unique_ptr<Logger> logger;
+  // Set in SharedReactor mode only, components fall back to their own threads otherwise
+  std::unique_ptr<Reactor> reactor;
+  std::unique_ptr<WorkerPool> workers;
+  std::unique_ptr<HotplugMonitor> hotplug_monitor;
+  size_t input_history_size = 0;
 
   DriverContext(
     std::unique_ptr<HidBackend> hid_backend,
     std::unique_ptr<Logger> logger)
   : hid_backend(std::move(hid_backend)),
     logger(std::move(logger)) { }
+
+  ~DriverContext() {
+    if (reactor) { reactor->stop(); }
+    if (workers) { workers->stop(); }
+  }
 };
 
 }  // namespace spacemouse_driver
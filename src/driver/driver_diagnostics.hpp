@@ -0,0 +1,59 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "spacemouse_driver/statistics.hpp"
+#include "util/latency_histogram.hpp"
+#include "util/trace_ring.hpp"
+
+namespace spacemouse_driver {
+
+// Always-on instrumentation of a single driver, shared by its components
+struct DriverDiagnostics {
+  static constexpr size_t TRACE_CAPACITY = 8192;
+
+  TraceRing trace;
+  LatencyHistogram read_to_parse;
+  LatencyHistogram parse_to_publish;
+  LatencyHistogram publish_to_dispatch;
+  LatencyHistogram callback;
+
+  DriverDiagnostics()
+  : trace(TRACE_CAPACITY) { }
+
+  LatencyStats latency_stats() const {
+    return LatencyStats{
+      read_to_parse.percentiles(),
+      parse_to_publish.percentiles(),
+      publish_to_dispatch.percentiles(),
+      callback.percentiles()
+    };
+  }
+
+  void reset_latency_stats() {
+    read_to_parse.reset();
+    parse_to_publish.reset();
+    publish_to_dispatch.reset();
+    callback.reset();
+  }
+};
+
+}  // namespace spacemouse_driver
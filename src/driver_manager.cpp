@@ -18,34 +18,83 @@
 
 #include "spacemouse_driver/driver_manager.hpp"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
 #include "spacemouse_driver/driver.hpp"
 #include "connection/connection_method.hpp"
+#include "connection/hidraw_backend.hpp"
 #include "device/device_registry.hpp"
 #include "driver/driver_context.hpp"
 
 namespace spacemouse_driver {
 
-DriverManager::DriverManager(std::unique_ptr<Logger> logger, LogLevel log_level)
+namespace {
+
+std::unique_ptr<HidBackend> make_backend(BackendType type) {
+  auto shared_device_manager = std::make_shared<SharedDeviceManager>();
+  switch (type) {
+    case BackendType::Hidraw:
+      return std::make_unique<HidrawBackend>(shared_device_manager);
+    case BackendType::Hidapi:
+      break;
+  }
+  return std::make_unique<HidBackend>(shared_device_manager);
+}
+
+}  // namespace
+
+DriverManager::DriverManager(
+  std::unique_ptr<Logger> logger, LogLevel log_level,
+  const DriverManagerOptions& options)
 : _context(
     std::make_shared<DriverContext>(
-      std::make_unique<HidBackend>(std::make_shared<SharedDeviceManager>()),
+      make_backend(options.backend),
       std::move(logger)
     )
 ),
+  _drivers_mutex(),
   _drivers() {
   if (!_context->logger) {
     throw std::invalid_argument("Logger instance cannot be null.");
   }
 
+  if (options.threading == ThreadingMode::SharedReactor) {
+    if (options.backend != BackendType::Hidraw) {
+      throw std::invalid_argument("Shared reactor mode requires the Hidraw backend.");
+    }
+    _context->reactor = std::make_unique<Reactor>();
+    _context->workers = std::make_unique<WorkerPool>(options.worker_threads);
+    _context->workers->start();
+    _context->reactor->start();
+  }
+
+  _context->input_history_size = options.input_history_size;
+
   set_log_level(log_level);
+
+  _context->hotplug_monitor = std::make_unique<HotplugMonitor>();
+  if (_context->hotplug_monitor->is_available()) {
+    // Subscribed before any driver exists, so the snapshot is dropped before drivers reconnect
+    _context->hotplug_monitor->subscribe(
+      [backend = _context->hid_backend.get()](const HotplugEvent& event) {
+        if (event.action != HotplugAction::Released) {
+          backend->invalidate_enumeration();
+        }
+      });
+    _context->hotplug_monitor->start(_context->reactor.get());
+  } else {
+    _context->logger->warning("Hotplug events unavailable, falling back to periodic device polling.");
+  }
 }
 
 DriverManager::DriverManager()
 : DriverManager(std::make_unique<ConsoleLogger>(), LogLevel::Warning) { }
 
+DriverManager::DriverManager(const DriverManagerOptions& options)
+: DriverManager(std::make_unique<ConsoleLogger>(), LogLevel::Warning, options) { }
+
 DriverManager::~DriverManager() {
   for (auto& driver : _drivers) {
     driver->stop();
@@ -56,9 +105,8 @@ std::shared_ptr<Driver> DriverManager::create_driver(const std::vector<Model>& m
   std::vector<Model> model_list_cpy = model_list;
   for (const auto& model : model_list_cpy) {
     if (!DeviceRegistry::is_supported(model)) {
-      _context->logger->error(
-        "Unsupported device model specified: " +
-        std::string(magic_enum::enum_name(model)));
+      _context->logger->log(
+        LogLevel::Error, "Unsupported device model specified: ", magic_enum::enum_name(model));
       return nullptr;
     }
   }
@@ -98,8 +146,33 @@ void DriverManager::set_log_level(LogLevel level) {
 std::shared_ptr<Driver> DriverManager::make_driver(
   const std::shared_ptr<ConnectionMethod>& conn_method) {
   auto driver = std::make_shared<Driver>(_context, conn_method);
+  std::lock_guard<std::mutex> lock(_drivers_mutex);
   _drivers.push_back(driver);
   return driver;
 }
 
+DriverCounters DriverManager::get_counters() const {
+  DriverCounters total{ };
+  std::lock_guard<std::mutex> lock(_drivers_mutex);
+  for (const auto& driver : _drivers) {
+    auto counters = driver->get_counters();
+    total.reports += counters.reports;
+    total.repeated_reports += counters.repeated_reports;
+    total.merged_reports += counters.merged_reports;
+    total.frames += counters.frames;
+    total.read_errors += counters.read_errors;
+    total.dispatched_frames += counters.dispatched_frames;
+    total.overwritten_frames += counters.overwritten_frames;
+    total.missed_ticks += counters.missed_ticks;
+    total.dropped_button_events += counters.dropped_button_events;
+    total.connect_attempts += counters.connect_attempts;
+    total.connects += counters.connects;
+    total.disconnects += counters.disconnects;
+    total.reconnects += counters.reconnects;
+    total.total_reconnect_time += counters.total_reconnect_time;
+    total.max_reconnect_time = std::max(total.max_reconnect_time, counters.max_reconnect_time);
+  }
+  return total;
+}
+
 }  // namespace spacemouse_driver
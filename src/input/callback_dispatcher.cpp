@@ -18,16 +18,44 @@
 
 #include "input/callback_dispatcher.hpp"
 
+#include <sys/prctl.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
 #include "driver/driver_context.hpp"
+#include "input/input_processor.hpp"
 
 namespace spacemouse_driver {
 
-CallbackDispatcher::CallbackDispatcher(std::shared_ptr<DriverContext> context)
+CallbackDispatcher::CallbackDispatcher(
+  std::shared_ptr<DriverContext> context,
+  InputProcessor& input_processor, DriverDiagnostics& diagnostics)
 : _context(context),
+  _input_processor(input_processor),
+  _diagnostics(diagnostics),
   _running(false),
+  _subscriptions(std::make_shared<SubscriptionRegistry>()),
+  _current_input{ },
+  _input_published{ },
+  _prev_input{ },
   _new_input(false),
+  _dispatched_frames(0),
+  _overwritten_frames(0),
+  _wake_requested(false),
   _zero_state_reported(false),
-  _instant_callbacks(false) {
+  _dispatched_buttons(0),
+  _instant_callbacks(false),
+  _interval_coalescing(Coalescing::Latest),
+  _dispatch_timer(0) {
+  if (_context->workers) {
+    _dispatch_task = std::make_unique<SerialTask>(
+      *_context->workers, [this] {
+        _context->reactor->reschedule_timer(_dispatch_timer, dispatch_due());
+      });
+  }
+  _button_group.reserve(ButtonCount);
   _context->logger->debug("CallbackDispatcher initialized");
 }
 
@@ -42,10 +70,22 @@ void CallbackDispatcher::start() {
   }
 
   _running = true;
-  _dispatch_thread = std::thread(
-    [this]() {
-      dispatch_loop();
-    });
+  auto now = Clock::now();
+  _callbacks_deadline = now + _callback_interval.load();
+  _callbacks_motion = _input_processor.get_motion(now);
+  if (_context->reactor) {
+    // Parked after every expiry, the dispatch re-arms it for the next deadline
+    _dispatch_timer = _context->reactor->add_timer(
+      _callbacks_deadline, [this] {
+        _dispatch_task->request();
+        return std::optional(Reactor::Clock::time_point::max());
+      });
+  } else {
+    _dispatch_thread = std::thread(
+      [this]() {
+        dispatch_loop();
+      });
+  }
   _context->logger->debug("CallbackDispatcher started");
 }
 
@@ -57,6 +97,10 @@ void CallbackDispatcher::stop() {
   _running = false;
   _input_cv.notify_all();
 
+  if (_context->reactor) {
+    _context->reactor->cancel_timer(_dispatch_timer);
+    _dispatch_task->wait_idle();
+  }
   if (_dispatch_thread.joinable()) {
     _dispatch_thread.join();
   }
@@ -64,39 +108,163 @@ void CallbackDispatcher::stop() {
 }
 
 void CallbackDispatcher::process_input(const Input& input) {
+  // Called right after the frame was published
+  auto published = Clock::now();
   {
     std::lock_guard<std::mutex> lock(_input_mutex);
+    if (_new_input) {
+      _overwritten_frames.fetch_add(1, std::memory_order_relaxed);
+    }
     _current_input = input;
+    _input_published = published;
     _new_input = true;
   }
-  if (_instant_callbacks) {
-    _input_cv.notify_all();
+
+  // Instant subscribers that skip the dispatch thread get the frame right here
+  {
+    auto subscribers = _subscriptions->subscribers();
+    for (const auto& subscriber : *subscribers) {
+      if (subscriber->options.delivery != Delivery::Instant) { continue; }
+      if (subscriber->options.execution == Execution::Inline) {
+        invoke_subscriber(*subscriber, input, true);
+      } else if (subscriber->options.execution == Execution::Executor) {
+        subscriber->post(input);
+      }
+    }
+  }
+
+  if (_instant_callbacks || _subscriptions->instant_count() > 0) {
+    request_dispatch();
   }
 }
 
+Subscription CallbackDispatcher::subscribe(
+  std::function<void(const Input&)> callback,
+  SubscriptionOptions options) {
+  if (!callback) {
+    throw std::invalid_argument("Subscription callback must not be empty");
+  }
+  if (options.delivery == Delivery::Interval && options.interval <= std::chrono::microseconds(0)) {
+    throw std::invalid_argument("Subscription interval must be positive");
+  }
+  if (options.execution == Execution::Inline && options.delivery != Delivery::Instant) {
+    throw std::invalid_argument("Inline execution requires instant delivery");
+  }
+  if (options.execution == Execution::Executor && !options.executor) {
+    throw std::invalid_argument("Executor execution requires an executor");
+  }
+
+  auto subscriber = std::make_shared<SubscriptionRegistry::Subscriber>();
+  subscriber->options = options;
+  subscriber->callback = std::move(callback);
+  // Only frames received from now on are delivered
+  Input ignored;
+  subscriber->last_sequence = _input_processor.get_latest_input(ignored);
+  auto now = Clock::now();
+  subscriber->next_deadline = now + options.interval;
+  subscriber->motion = _input_processor.get_motion(now);
+  uint64_t id = _subscriptions->add(std::move(subscriber));
+
+  // The new deadline may be earlier than the one the dispatcher sleeps until
+  request_dispatch();
+  return Subscription(_subscriptions, id);
+}
+
+void CallbackDispatcher::register_input_callback(std::function<void(const Input&)> callback) {
+  _callbacks.update(
+    [&callback](CallbackTable& table) {
+      table.input = std::move(callback);
+    });
+}
+
+void CallbackDispatcher::delete_input_callback() {
+  _callbacks.update(
+    [](CallbackTable& table) {
+      table.input = nullptr;
+    });
+}
+
 void CallbackDispatcher::register_stick_callback(std::function<void(StickInput)> callback) {
-  std::lock_guard<std::mutex> lock(_callback_mutex);
-  _stick_callback = callback;
+  _callbacks.update(
+    [&callback](CallbackTable& table) {
+      table.stick = std::move(callback);
+    });
 }
 
 void CallbackDispatcher::register_button_callback(
   Button button,
   std::function<void(ButtonInput)> callback) {
-  std::lock_guard<std::mutex> lock(_callback_mutex);
-  _button_callbacks[*magic_enum::enum_index(button)] = callback;
+  size_t index = *magic_enum::enum_index(button);
+  _callbacks.update(
+    [index, &callback](CallbackTable& table) {
+      table.buttons[index] = std::move(callback);
+    });
+}
+
+void CallbackDispatcher::register_button_mask_callback(
+  std::function<void(ButtonMask, ButtonMask)> callback) {
+  _callbacks.update(
+    [&callback](CallbackTable& table) {
+      table.button_mask = std::move(callback);
+    });
+}
+
+void CallbackDispatcher::register_motion_callback(
+  std::function<void(const StickMotion&)> callback) {
+  _callbacks.update(
+    [&callback](CallbackTable& table) {
+      table.motion = std::move(callback);
+    });
+}
+
+void CallbackDispatcher::register_button_event_callback(
+  std::function<void(const ButtonEvent&)> callback) {
+  _callbacks.update(
+    [&callback](CallbackTable& table) {
+      table.button_event = std::move(callback);
+    });
 }
 
 void CallbackDispatcher::delete_stick_callback() {
-  std::lock_guard<std::mutex> lock(_callback_mutex);
-  _stick_callback = nullptr;
+  _callbacks.update(
+    [](CallbackTable& table) {
+      table.stick = nullptr;
+    });
 }
 
 void CallbackDispatcher::delete_button_callback(Button button) {
-  std::lock_guard<std::mutex> lock(_callback_mutex);
-  _button_callbacks[*magic_enum::enum_index(button)] = nullptr;
+  size_t index = *magic_enum::enum_index(button);
+  _callbacks.update(
+    [index](CallbackTable& table) {
+      table.buttons[index] = nullptr;
+    });
 }
 
-void CallbackDispatcher::set_callback_interval(std::chrono::milliseconds interval) {
+void CallbackDispatcher::delete_button_mask_callback() {
+  _callbacks.update(
+    [](CallbackTable& table) {
+      table.button_mask = nullptr;
+    });
+}
+
+void CallbackDispatcher::delete_motion_callback() {
+  _callbacks.update(
+    [](CallbackTable& table) {
+      table.motion = nullptr;
+    });
+}
+
+void CallbackDispatcher::delete_button_event_callback() {
+  _callbacks.update(
+    [](CallbackTable& table) {
+      table.button_event = nullptr;
+    });
+}
+
+void CallbackDispatcher::set_callback_interval(std::chrono::microseconds interval) {
+  if (interval <= std::chrono::microseconds(0)) {
+    throw std::invalid_argument("Callback interval must be positive");
+  }
   _callback_interval = interval;
 }
 
@@ -104,72 +272,300 @@ void CallbackDispatcher::set_instant_callbacks(bool enabled) {
   _instant_callbacks = enabled;
 }
 
+void CallbackDispatcher::set_interval_coalescing(Coalescing coalescing) {
+  if (coalescing == Coalescing::EverySample) {
+    throw std::invalid_argument("Interval callbacks receive a single stick value per tick");
+  }
+  _interval_coalescing = coalescing;
+}
+
+JitterStats CallbackDispatcher::get_jitter_stats() const {
+  return _callbacks_jitter.stats();
+}
+
+void CallbackDispatcher::read_counters(DriverCounters& counters) const {
+  counters.dispatched_frames = _dispatched_frames.load(std::memory_order_relaxed);
+  counters.overwritten_frames = _overwritten_frames.load(std::memory_order_relaxed);
+  counters.missed_ticks = _callbacks_jitter.stats().missed;
+}
+
 void CallbackDispatcher::dispatch_loop() {
-  while (_running) {
-    Input input_to_process;
+  // Deadlines are absolute, the default slack of 50 us would be the largest source of jitter
+  prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL);
 
+  auto deadline = _callbacks_deadline;
+  while (_running) {
     {
       std::unique_lock<std::mutex> lock(_input_mutex);
-      auto callback_interval = _callback_interval.load();
-      _input_cv.wait_for(
-        lock, callback_interval, [this] {
-          return !_running || (_new_input && _instant_callbacks);
+      _input_cv.wait_until(
+        lock, deadline, [this] {
+          return !_running || _wake_requested;
         });
+      _wake_requested = false;
+    }
 
-      if (!_running) { break; }
+    if (!_running) { break; }
 
-      if (_new_input) {
-        input_to_process = _current_input;
-        _new_input = false;
-      } else {
-        continue;
-      }
+    deadline = dispatch_due();
+  }
+}
+
+void CallbackDispatcher::request_dispatch() {
+  // A disconnect during Driver::stop() reports input after the dispatcher stopped, a task queued
+  // then would outlive it
+  if (!_running) {
+    return;
+  }
+  if (_dispatch_task) {
+    _dispatch_task->request();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(_input_mutex);
+    _wake_requested = true;
+  }
+  _input_cv.notify_all();
+}
+
+template<typename Run>
+void CallbackDispatcher::run_measured(uint32_t trace_id, Run&& run) {
+  auto begin = Clock::now();
+  _diagnostics.trace.record(TraceEvent::CallbackBegin, trace_id, begin);
+  run();
+  auto end = Clock::now();
+  _diagnostics.trace.record(TraceEvent::CallbackEnd, trace_id, end);
+  _diagnostics.callback.record(end - begin);
+}
+
+CallbackDispatcher::Clock::time_point CallbackDispatcher::dispatch_due() {
+  auto now = Clock::now();
+  bool new_input;
+  {
+    std::lock_guard<std::mutex> lock(_input_mutex);
+    new_input = _new_input;
+  }
+
+  if (now >= _callbacks_deadline) {
+    auto lateness = std::chrono::duration_cast<std::chrono::microseconds>(now - _callbacks_deadline);
+    _diagnostics.trace.record(
+      TraceEvent::DispatchWake,
+      static_cast<uint32_t>(std::min<int64_t>(lateness.count(), UINT32_MAX)), now);
+    auto motion = _input_processor.get_motion(now);
+    auto stick_motion = motion_between(_callbacks_motion, motion);
+    _callbacks_motion = motion;
+    run_measured(
+      0, [&] {
+        dispatch_pending(&stick_motion);
+      });
+    _callbacks_deadline = _callbacks_jitter.tick(_callbacks_deadline, now, _callback_interval.load());
+  } else if (new_input && _instant_callbacks) {
+    run_measured(
+      0, [this] {
+        dispatch_pending();
+      });
+  }
+
+  auto next = _callbacks_deadline;
+  auto subscribers = _subscriptions->subscribers();
+  for (const auto& subscriber : *subscribers) {
+    next = std::min(next, deliver_due(*subscriber, now));
+  }
+  return next;
+}
+
+void CallbackDispatcher::dispatch_pending(const StickMotion* motion) {
+  Input input_to_process;
+  bool new_input;
+  Clock::time_point published;
+  {
+    std::lock_guard<std::mutex> lock(_input_mutex);
+    new_input = _new_input;
+    input_to_process = _current_input;
+    published = _input_published;
+    _new_input = false;
+  }
+  if (new_input) {
+    _dispatched_frames.fetch_add(1, std::memory_order_relaxed);
+    _diagnostics.publish_to_dispatch.record(Clock::now() - published);
+  }
+
+  // Pinned for the whole pass, callbacks registered meanwhile take effect on the next one
+  auto callbacks = _callbacks.read();
+
+  if (motion && callbacks->motion) {
+    callbacks->motion(*motion);
+  }
+  bool use_mean = motion && _interval_coalescing.load() == Coalescing::Mean;
+
+  if (!new_input && !use_mean) {
+    dispatch_button_events(*callbacks);
+    // Repeated reports of a stick held still are not published, keep reporting its deflection
+    if (_prev_input.stick != StickInput{ }) {
+      invoke_stick_callback(*callbacks, _prev_input.stick);
     }
+    return;
+  }
 
-    // Process button callbacks
-    for (size_t i = 0; i < ButtonCount; ++i) {
-      Button button = magic_enum::enum_value<Button>(i);
-      if (input_to_process.buttons[i] != _prev_input.buttons[i]) {
-        invoke_button_callback(button, input_to_process.buttons[i]);
-      }
+  if (new_input && callbacks->input) {
+    callbacks->input(input_to_process);
+  }
+
+  dispatch_button_events(*callbacks);
+
+  // Process stick callbacks, on interval ticks the mean covers motion between the reports
+  const StickInput& stick = use_mean ? motion->mean : input_to_process.stick;
+  if (stick == StickInput{ }) {
+    if (!_zero_state_reported) {
+      invoke_stick_callback(*callbacks, StickInput{ });
+      _zero_state_reported = true;
+    }
+  } else {
+    invoke_stick_callback(*callbacks, stick);
+    _zero_state_reported = false;
+  }
+
+  _prev_input = input_to_process;
+}
+
+CallbackDispatcher::Clock::time_point CallbackDispatcher::deliver_due(
+  SubscriptionRegistry::Subscriber& subscriber,
+  Clock::time_point now) {
+  if (subscriber.options.delivery == Delivery::Instant) {
+    // Inline and executor subscribers already received the frame from process_input()
+    if (subscriber.options.execution == Execution::Dispatcher) {
+      deliver(subscriber, now);
     }
+    return Clock::time_point::max();
+  }
+  if (now >= subscriber.next_deadline) {
+    subscriber.next_deadline = subscriber.jitter.tick(
+      subscriber.next_deadline, now,
+      subscriber.options.interval);
+    deliver(subscriber, now);
+  }
+  return subscriber.next_deadline;
+}
+
+void CallbackDispatcher::deliver(
+  SubscriptionRegistry::Subscriber& subscriber,
+  Clock::time_point now) {
+  auto hand_off = [this, &subscriber](const Input& frame, bool fresh) {
+      if (subscriber.options.execution == Execution::Executor) {
+        subscriber.post(frame);
+      } else {
+        invoke_subscriber(subscriber, frame, fresh);
+      }
+    };
 
-    // Process stick callbacks
-    if (input_to_process.stick == StickInput{ }) {
-      if (!_zero_state_reported) {
-        invoke_stick_callback(StickInput{ });
-        _zero_state_reported = true;
+  if (subscriber.options.coalescing == Coalescing::EverySample && _context->input_history_size > 0) {
+    // Frames already overwritten in the history are skipped
+    std::array<Input, 16> frames;
+    while (subscriber.active) {
+      auto read = _input_processor.get_input_since(
+        subscriber.last_sequence, frames.data(),
+        frames.size());
+      subscriber.last_sequence = read.last_sequence;
+      for (size_t i = 0; i < read.count; ++i) {
+        hand_off(frames[i], true);
       }
-    } else {
-      invoke_stick_callback(input_to_process.stick);
-      _zero_state_reported = false;
+      if (read.count < frames.size()) { break; }
     }
+    return;
+  }
 
-    _prev_input = input_to_process;
+  Input input;
+  uint64_t sequence = _input_processor.get_latest_input(input);
+  bool fresh = sequence > subscriber.last_sequence;
+  // Interval subscribers sample the current state on every tick, even if it did not change
+  bool sample = subscriber.options.delivery == Delivery::Interval && sequence > 0;
+  if (fresh || sample) {
+    subscriber.last_sequence = sequence;
+    if (subscriber.options.coalescing == Coalescing::Mean && subscriber.options.delivery == Delivery::Interval) {
+      auto motion = _input_processor.get_motion(now);
+      input.stick = motion_between(subscriber.motion, motion).mean;
+      subscriber.motion = motion;
+    }
+    hand_off(input, fresh);
   }
 }
 
-void CallbackDispatcher::invoke_stick_callback(const StickInput& input) {
-  std::function<void(StickInput)> callback;
-  {
-    std::lock_guard<std::mutex> lock(_callback_mutex);
-    callback = _stick_callback;
+void CallbackDispatcher::invoke_subscriber(
+  SubscriptionRegistry::Subscriber& subscriber, const Input& frame,
+  bool fresh) {
+  run_measured(
+    static_cast<uint32_t>(subscriber.id), [&] {
+      subscriber.invoke(frame, fresh);
+    });
+}
+
+void CallbackDispatcher::dispatch_button_events(const CallbackTable& callbacks) {
+  // Every edge is reported, even if the button changed back before this dispatch. Edges of one
+  // frame share a mask callback unless a button changed twice within the frame.
+  ButtonQueueEntry entry;
+  ButtonMask grouped = 0;
+  while (_input_processor.pop_button_event(entry)) {
+    const ButtonEvent& event = entry.event;
+    if (entry.resync) {
+      flush_button_group(callbacks);
+      grouped = 0;
+      resync_buttons(callbacks, entry);
+      continue;
+    }
+    ButtonMask bit = ButtonMask{ 1 } << *magic_enum::enum_index(event.button);
+    if ((grouped & bit) || (grouped && _button_group.back().sequence != event.sequence)) {
+      flush_button_group(callbacks);
+      grouped = 0;
+    }
+    grouped |= bit;
+    _button_group.push_back(event);
   }
+  flush_button_group(callbacks);
+}
 
-  if (callback) {
-    callback(input);
+void CallbackDispatcher::resync_buttons(const CallbackTable& callbacks, const ButtonQueueEntry& entry) {
+  // Edges lost to a full queue leave the dispatched state behind, catch up with the frame
+  _context->logger->log(LogLevel::Warning, "Button events were dropped, callbacks fell behind the device");
+  for (ButtonMask bits = _dispatched_buttons ^ entry.buttons; bits != 0; bits &= bits - 1) {
+    size_t index = static_cast<size_t>(__builtin_ctz(bits));
+    ButtonInput pressed = ((entry.buttons >> index) & 1) != 0;
+    _button_group.push_back(
+      ButtonEvent{ magic_enum::enum_value<Button>(index), pressed, entry.event.sequence,
+        entry.event.timestamp });
   }
+  flush_button_group(callbacks);
 }
 
-void CallbackDispatcher::invoke_button_callback(Button button, ButtonInput input) {
-  std::function<void(ButtonInput)> callback;
-  {
-    std::lock_guard<std::mutex> lock(_callback_mutex);
-    callback = _button_callbacks[*magic_enum::enum_index(button)];
+void CallbackDispatcher::flush_button_group(const CallbackTable& callbacks) {
+  if (_button_group.empty()) {
+    return;
+  }
+
+  ButtonMask changed = 0;
+  for (const auto& event : _button_group) {
+    ButtonMask bit = ButtonMask{ 1 } << *magic_enum::enum_index(event.button);
+    _dispatched_buttons = event.pressed ? (_dispatched_buttons | bit) : (_dispatched_buttons & ~bit);
+    changed |= bit;
+  }
+  if (callbacks.button_mask) {
+    callbacks.button_mask(_dispatched_buttons, changed);
   }
+  for (const auto& event : _button_group) {
+    if (callbacks.button_event) {
+      callbacks.button_event(event);
+    }
+    size_t index = *magic_enum::enum_index(event.button);
+    if (callbacks.buttons[index]) {
+      callbacks.buttons[index](event.pressed);
+    }
+  }
+  _button_group.clear();
+}
 
-  if (callback) {
-    callback(input);
+void CallbackDispatcher::invoke_stick_callback(
+  const CallbackTable& callbacks,
+  const StickInput& input) {
+  if (callbacks.stick) {
+    callbacks.stick(input);
   }
 }
 
@@ -28,15 +28,27 @@
 #include <array>
 
 #include "spacemouse_driver/input_types.hpp"
+#include "spacemouse_driver/subscription.hpp"
+#include "input/subscription_registry.hpp"
+#include "input/motion_integral.hpp"
+#include "driver/driver_diagnostics.hpp"
+#include "reactor/reactor.hpp"
+#include "reactor/worker_pool.hpp"
+#include "util/jitter_recorder.hpp"
+#include "util/rcu_pointer.hpp"
 
 namespace spacemouse_driver {
 
 class DriverContext;
+class InputProcessor;
+struct ButtonQueueEntry;
 
 class CallbackDispatcher
 {
 public:
-  explicit CallbackDispatcher(std::shared_ptr<DriverContext> context);
+  CallbackDispatcher(
+    std::shared_ptr<DriverContext> context, InputProcessor& input_processor,
+    DriverDiagnostics& diagnostics);
   ~CallbackDispatcher();
 
   // Thread control
@@ -47,43 +59,102 @@ public:
   void process_input(const Input& input);
 
   // Callback registration
+  void register_input_callback(std::function<void(const Input&)> callback);
+  void delete_input_callback();
   void register_stick_callback(std::function<void(StickInput)> callback);
   void register_button_callback(Button button, std::function<void(ButtonInput)> callback);
+  void register_button_mask_callback(std::function<void(ButtonMask, ButtonMask)> callback);
+  void register_motion_callback(std::function<void(const StickMotion&)> callback);
+  void register_button_event_callback(std::function<void(const ButtonEvent&)> callback);
   void delete_stick_callback();
   void delete_button_callback(Button button);
+  void delete_button_mask_callback();
+  void delete_motion_callback();
+  void delete_button_event_callback();
+
+  // Subscriptions, each delivered at its own rate
+  Subscription subscribe(std::function<void(const Input&)> callback, SubscriptionOptions options);
 
   // Config
-  void set_callback_interval(std::chrono::milliseconds interval);
+  void set_callback_interval(std::chrono::microseconds interval);
   void set_instant_callbacks(bool enabled);
+  void set_interval_coalescing(Coalescing coalescing);
+
+  // Statistics
+  JitterStats get_jitter_stats() const;
+  // Fills the counters owned by the dispatcher
+  void read_counters(DriverCounters& counters) const;
 
 private:
+  using Clock = std::chrono::steady_clock;
+
   std::shared_ptr<DriverContext> _context;
+  InputProcessor& _input_processor;  // Source of the frames and button edges that are dispatched
+  DriverDiagnostics& _diagnostics;
   std::atomic<bool> _running;
   std::thread _dispatch_thread;
 
-  // Callback handling
-  std::mutex _callback_mutex;
-  std::function<void(StickInput)> _stick_callback;
-  std::array<std::function<void(ButtonInput)>, ButtonCount> _button_callbacks;
+  // Callback handling, replaced as a whole on registration so dispatch never locks or copies
+  struct CallbackTable {
+    std::function<void(const Input&)> input;
+    std::function<void(StickInput)> stick;
+    std::array<std::function<void(ButtonInput)>, ButtonCount> buttons;
+    std::function<void(ButtonMask, ButtonMask)> button_mask;
+    std::function<void(const StickMotion&)> motion;
+    std::function<void(const ButtonEvent&)> button_event;
+  };
+  RcuPointer<CallbackTable> _callbacks;
+  std::shared_ptr<SubscriptionRegistry> _subscriptions;
 
   // Input data
   std::mutex _input_mutex;
   Input _current_input;
+  Clock::time_point _input_published;
   Input _prev_input;
   std::condition_variable _input_cv;
   bool _new_input;
+  std::atomic<uint64_t> _dispatched_frames;
+  std::atomic<uint64_t> _overwritten_frames;
+  bool _wake_requested;  // Something is due before the scheduled deadline
   bool _zero_state_reported;
 
+  // Button edges drained from the input processor, touched by the dispatching thread only
+  ButtonMask _dispatched_buttons;
+  std::vector<ButtonEvent> _button_group;  // Edges reported together in one mask callback
+
   // Config
-  std::atomic<std::chrono::milliseconds> _callback_interval{ std::chrono::milliseconds(20) };
+  std::atomic<std::chrono::microseconds> _callback_interval{ std::chrono::milliseconds(20) };
   std::atomic_bool _instant_callbacks;
+  std::atomic<Coalescing> _interval_coalescing;  // Latest or Mean, stick value passed on interval ticks
+
+  // Shared reactor mode: one timer armed for the earliest deadline, dispatch runs on the worker pool
+  Reactor::TimerId _dispatch_timer;
+  std::unique_ptr<SerialTask> _dispatch_task;
+
+  // Next interval dispatch of the registered callbacks, touched by the dispatching thread only
+  Clock::time_point _callbacks_deadline;
+  JitterRecorder _callbacks_jitter;
+  MotionIntegral _callbacks_motion;  // Sampled on the previous tick
 
   // Main dispatch loop
   void dispatch_loop();
+  void request_dispatch();
+  // Runs the callbacks and subscriptions that are due, returns the earliest next deadline
+  Clock::time_point dispatch_due();
+  // Runs the registered callbacks, motion is set on interval ticks
+  void dispatch_pending(const StickMotion* motion = nullptr);
+  Clock::time_point deliver_due(SubscriptionRegistry::Subscriber& subscriber, Clock::time_point now);
+  void deliver(SubscriptionRegistry::Subscriber& subscriber, Clock::time_point now);
+  void invoke_subscriber(SubscriptionRegistry::Subscriber& subscriber, const Input& frame, bool fresh);
+  // Runs callbacks, tracing and timing their execution
+  template<typename Run>
+  void run_measured(uint32_t trace_id, Run&& run);
 
   // Helpers
-  void invoke_stick_callback(const StickInput& input);
-  void invoke_button_callback(Button button, ButtonInput input);
+  void dispatch_button_events(const CallbackTable& callbacks);
+  void flush_button_group(const CallbackTable& callbacks);
+  void resync_buttons(const CallbackTable& callbacks, const ButtonQueueEntry& entry);
+  void invoke_stick_callback(const CallbackTable& callbacks, const StickInput& input);
 };
 
 }  // namespace spacemouse_driver
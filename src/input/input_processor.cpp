@@ -18,14 +18,38 @@
 
 #include "input/input_processor.hpp"
 
+#include <cstring>
+
 #include "driver/driver_context.hpp"
 
 namespace spacemouse_driver {
 
-InputProcessor::InputProcessor(std::shared_ptr<DriverContext> context)
+InputProcessor::InputProcessor(std::shared_ptr<DriverContext> context, DriverDiagnostics& diagnostics)
 : _context(context),
+  _diagnostics(diagnostics),
   _running(false),
-  _data_timeout(std::chrono::milliseconds(1000)) {
+  _motion_state{ },
+  _button_events(BUTTON_EVENT_CAPACITY),
+  _published_buttons(0),
+  _button_overflow(false),
+  _dropped_button_events(0),
+  _frame{ },
+  _reset_frame(false),
+  _edge_buttons(0),
+  _waiters(0),
+  _data_timeout(std::chrono::milliseconds(1000)),
+  _report_cache{ },
+  _last_report_time(std::chrono::steady_clock::time_point{ }),
+  _repeated_reports(0),
+  _reports(0),
+  _merged_reports(0),
+  _published_frames(0),
+  _read_errors(0),
+  _watched_fd(-1) {
+  if (_context->input_history_size > 0) {
+    _history = std::make_unique<HistoryRing<Input>>(_context->input_history_size);
+  }
+  _frame_edges.reserve(ButtonCount);
   _context->logger->debug("InputProcessor initialized");
 }
 
@@ -40,10 +64,21 @@ void InputProcessor::start() {
   }
 
   _running = true;
-  _process_thread = std::thread(
-    [this]() {
-      process_loop();
-    });
+  if (_context->reactor) {
+    std::shared_ptr<DeviceHandle> current_device;
+    {
+      std::lock_guard<std::mutex> lock(_device_mutex);
+      current_device = _device;
+    }
+    if (current_device) {
+      watch_device(current_device);
+    }
+  } else {
+    _process_thread = std::thread(
+      [this]() {
+        process_loop();
+      });
+  }
   _context->logger->debug("InputProcessor started");
 }
 
@@ -52,7 +87,18 @@ void InputProcessor::stop() {
     return;
   }
 
-  _running = false;
+  std::shared_ptr<DeviceHandle> current_device;
+  {
+    std::lock_guard<std::mutex> lock(_device_mutex);
+    _running = false;
+    current_device = _device;
+  }
+  _device_cv.notify_all();
+  if (current_device) {
+    _context->hid_backend->interrupt(current_device);
+  }
+  unwatch_device();
+
   if (_process_thread.joinable()) {
     _process_thread.join();
   }
@@ -60,18 +106,84 @@ void InputProcessor::stop() {
 }
 
 void InputProcessor::set_device(std::shared_ptr<DeviceHandle> device) {
-  std::lock_guard<std::mutex> lock(_device_mutex);
-  _device = device;
+  {
+    std::lock_guard<std::mutex> lock(_device_mutex);
+    _device = device;
+  }
+  _device_cv.notify_all();
+  if (_context->reactor && _running && device) {
+    watch_device(device);
+  }
 }
 
 void InputProcessor::clear_device() {
-  std::lock_guard<std::mutex> lock(_device_mutex);
-  _device = nullptr;
-  _last_input.write(Input{ });
+  unwatch_device();
+  {
+    std::lock_guard<std::mutex> lock(_device_mutex);
+    _device = nullptr;
+  }
+  _reset_frame = true;
+  Input cleared{ };
+  cleared.timestamp = std::chrono::steady_clock::now();
+  publish(cleared);
+}
+
+uint64_t InputProcessor::get_latest_input(Input& input) const {
+  return _last_input.read(input);
+}
+
+InputHistoryRead InputProcessor::get_input_since(
+  uint64_t sequence, Input* frames,
+  size_t max_frames) const {
+  if (!_history) {
+    return InputHistoryRead{ 0, 0, sequence };
+  }
+  auto result = _history->read_since(sequence, frames, max_frames);
+  return InputHistoryRead{ result.count, result.overwritten, result.last };
+}
+
+MotionIntegral InputProcessor::get_motion(std::chrono::steady_clock::time_point now) const {
+  MotionIntegral motion;
+  _motion.read(motion);
+  if (now > motion.time) {
+    // Multiplied as unsigned, so products wrap like the sums instead of overflowing
+    auto held = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - motion.time).count());
+    for (size_t i = 0; i < AxisCount; ++i) {
+      motion.raw_ns[i] += static_cast<uint64_t>(motion.raw[i]) * held;
+    }
+    motion.time = now;
+  }
+  return motion;
+}
+
+bool InputProcessor::pop_button_event(ButtonQueueEntry& entry) {
+  return _button_events.pop(entry);
 }
 
-Input InputProcessor::get_latest_input() const {
-  return _last_input.read();
+uint64_t InputProcessor::wait_for_input(
+  uint64_t last_sequence, std::chrono::milliseconds timeout,
+  Input& input) const {
+  uint64_t sequence = _last_input.read(input);
+  if (sequence > last_sequence) {
+    return sequence;
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  _waiters.fetch_add(1, std::memory_order_relaxed);
+  // Pairs with the fence in publish(), either the writer sees the waiter or the waiter sees the frame
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  {
+    std::unique_lock<std::mutex> lock(_wait_mutex);
+    _wait_cv.wait_until(
+      lock, deadline, [this, last_sequence] {
+        return _last_input.sequence() > last_sequence;
+      });
+  }
+  _waiters.fetch_sub(1, std::memory_order_relaxed);
+
+  sequence = _last_input.read(input);
+  return sequence > last_sequence ? sequence : 0;
 }
 
 void InputProcessor::set_data_callback(DataCallback callback) {
@@ -79,96 +191,280 @@ void InputProcessor::set_data_callback(DataCallback callback) {
   _data_callback = callback;
 }
 
+std::chrono::steady_clock::time_point InputProcessor::get_last_report_time() const {
+  return _last_report_time.load(std::memory_order_relaxed);
+}
+
+uint64_t InputProcessor::get_repeated_report_count() const {
+  return _repeated_reports.load(std::memory_order_relaxed);
+}
+
+void InputProcessor::read_counters(DriverCounters& counters) const {
+  counters.reports = _reports.load(std::memory_order_relaxed);
+  counters.repeated_reports = _repeated_reports.load(std::memory_order_relaxed);
+  counters.merged_reports = _merged_reports.load(std::memory_order_relaxed);
+  counters.frames = _published_frames.load(std::memory_order_relaxed);
+  counters.read_errors = _read_errors.load(std::memory_order_relaxed);
+  counters.dropped_button_events = _dropped_button_events.load(std::memory_order_relaxed);
+}
+
+void InputProcessor::watch_device(const std::shared_ptr<DeviceHandle>& device) {
+  unwatch_device();
+  {
+    std::lock_guard<std::mutex> lock(_device_mutex);
+    _watched_fd = device->fd;
+  }
+  _context->reactor->add_fd(
+    device->fd, [this, device](uint32_t) {
+      on_readable(device);
+    });
+}
+
+void InputProcessor::unwatch_device() {
+  int fd;
+  {
+    std::lock_guard<std::mutex> lock(_device_mutex);
+    fd = _watched_fd;
+    _watched_fd = -1;
+  }
+  // Outside the lock, removal waits for a running handler which may clear the device
+  if (fd >= 0) {
+    _context->reactor->remove_fd(fd);
+  }
+}
+
+void InputProcessor::on_readable(std::shared_ptr<DeviceHandle> device) {
+  uint8_t buf[BUFFER_SIZE];
+
+  while (_running) {
+    int res = _context->hid_backend->try_read(device, buf, BUFFER_SIZE);
+    if (res < 0) {
+      unwatch_device();
+      handle_read_error();
+      return;
+    }
+    if (res == 0) {
+      return;
+    }
+    if (!assemble_frame(device, buf, res, std::chrono::steady_clock::now())) {
+      unwatch_device();
+      handle_read_error();
+      return;
+    }
+  }
+}
+
 void InputProcessor::process_loop() {
   uint8_t buf[BUFFER_SIZE];
 
   while (_running) {
     std::shared_ptr<DeviceHandle> current_device;
     {
-      std::lock_guard<std::mutex> lock(_device_mutex);
+      std::unique_lock<std::mutex> lock(_device_mutex);
+      _device_cv.wait(
+        lock, [this] {
+          return !_running || _device;
+        });
       current_device = _device;
     }
 
     if (!current_device) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
       continue;
     }
 
     int res = _context->hid_backend->read(current_device, buf, BUFFER_SIZE);
+    auto timestamp = std::chrono::steady_clock::now();
 
     if (res < 0) {
-      // Read error = disconnected
-      _context->logger->debug("Read error from device");
-
-      DataCallback callback;
-      {
-        std::lock_guard<std::mutex> lock(_callback_mutex);
-        callback = _data_callback;
-      }
-
-      if (callback) {
-        Input error_input;
-        bool error = true;
-        callback(error_input, error);
-      }
-
+      handle_read_error();
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
       continue;
     }
 
+    // Read timed out or was interrupted
     if (res == 0) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
       continue;
     }
 
-    Input curr_input = parse(buf, static_cast<size_t>(res), current_device->config);
-    _last_input.write(curr_input);
+    if (!assemble_frame(current_device, buf, res, timestamp)) {
+      handle_read_error();
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  }
+}
+
+bool InputProcessor::assemble_frame(
+  std::shared_ptr<DeviceHandle>& device, uint8_t* buf, int length,
+  std::chrono::steady_clock::time_point timestamp) {
+  if (_reset_frame.load(std::memory_order_relaxed) && _reset_frame.exchange(false)) {
+    _frame = Input{ };
+    _report_cache = { };
+    _edge_buttons = 0;
+  }
 
-    DataCallback callback;
-    {
-      std::lock_guard<std::mutex> lock(_callback_mutex);
-      callback = _data_callback;
+  _diagnostics.trace.record(TraceEvent::ReadReturned, static_cast<uint32_t>(length), timestamp);
+
+  // Reports already queued behind the first one belong to the same device update
+  uint32_t report_count = 0;
+  uint32_t repeated_count = 0;
+  while (length > 0) {
+    if (is_repeated_report(buf, static_cast<size_t>(length))) {
+      ++repeated_count;
+    } else {
+      device->parser(buf, static_cast<size_t>(length), _frame);
+      collect_edges(timestamp);
+    }
+    if (++report_count == MAX_MERGED_REPORTS) {
+      break;
     }
+    length = _context->hid_backend->try_read(device, buf, BUFFER_SIZE);
+  }
 
-    if (callback) {
-      callback(curr_input, false);
+  auto parsed = std::chrono::steady_clock::now();
+  _diagnostics.read_to_parse.record(parsed - timestamp);
+  _diagnostics.trace.record(TraceEvent::ParseDone, report_count | repeated_count << 16, parsed);
+  _last_report_time.store(timestamp, std::memory_order_relaxed);
+  _reports.fetch_add(report_count, std::memory_order_relaxed);
+  if (report_count > 1) {
+    _merged_reports.fetch_add(report_count - 1, std::memory_order_relaxed);
+  }
+  if (repeated_count > 0) {
+    _repeated_reports.fetch_add(repeated_count, std::memory_order_relaxed);
+  }
+  // A resting device keeps repeating its last report, nothing to publish or dispatch
+  if (repeated_count == report_count) {
+    return length >= 0;
+  }
+
+  _frame.report_count = report_count;
+  _frame.timestamp = timestamp;
+  publish(_frame, &_frame_edges);
+  _frame_edges.clear();
+  _published_frames.fetch_add(1, std::memory_order_relaxed);
+  auto published = std::chrono::steady_clock::now();
+  _diagnostics.parse_to_publish.record(published - parsed);
+  _diagnostics.trace.record(TraceEvent::Published, static_cast<uint32_t>(_frame.sequence), published);
+
+  DataCallback callback;
+  {
+    std::lock_guard<std::mutex> lock(_callback_mutex);
+    callback = _data_callback;
+  }
+
+  if (callback) {
+    callback(_frame, false);
+  }
+  return length >= 0;
+}
+
+bool InputProcessor::is_repeated_report(const uint8_t* data, size_t length) {
+  CachedReport* free_slot = nullptr;
+  for (auto& cached : _report_cache) {
+    if (cached.length == 0) {
+      free_slot = free_slot ? free_slot : &cached;
+      continue;
+    }
+    if (cached.data[0] != data[0]) {
+      continue;
     }
+    if (cached.length == length && std::memcmp(cached.data.data(), data, length) == 0) {
+      return true;
+    }
+    free_slot = &cached;
+    break;
+  }
+  // Report IDs beyond the cache size are simply never treated as repeated
+  if (free_slot) {
+    free_slot->length = length;
+    std::memcpy(free_slot->data.data(), data, length);
+  }
+  return false;
+}
+
+void InputProcessor::collect_edges(std::chrono::steady_clock::time_point timestamp) {
+  for (ButtonMask bits = _frame.buttons.mask ^ _edge_buttons; bits != 0; bits &= bits - 1) {
+    size_t index = static_cast<size_t>(__builtin_ctz(bits));
+    _frame_edges.push_back(
+      ButtonEvent{ magic_enum::enum_value<Button>(index), _frame.buttons[index], 0, timestamp });
   }
+  _edge_buttons = _frame.buttons.mask;
 }
 
-Input InputProcessor::parse(const uint8_t* data, size_t length, const DeviceConfig& config) const {
-  Input input;
+void InputProcessor::handle_read_error() {
+  // Read error = disconnected
+  _diagnostics.trace.record(TraceEvent::ReadError);
+  _read_errors.fetch_add(1, std::memory_order_relaxed);
+  _context->logger->log(LogLevel::Debug, "Read error from device");
 
-  // Parse axis data
-  for (size_t i = 0; i < AxisCount; ++i) {
-    auto mapping = config.get_axis_mapping(magic_enum::enum_value<Axis>(i));
-    auto raw_data = mapping.parse(data, length);
-    if (!raw_data) { continue; }
-    double normalized_value = static_cast<double>(raw_data.value()) / config.axis_div;
-    input.stick.axis[i] = normalized_value;
+  DataCallback callback;
+  {
+    std::lock_guard<std::mutex> lock(_callback_mutex);
+    callback = _data_callback;
   }
 
-  // Parse button data
-  Input last_input = _last_input.read();
-  for (size_t i = 0; i < ButtonCount; ++i) {
-    auto mapping = config.get_button_mapping(magic_enum::enum_value<Button>(i));
-    if (!mapping) {
-      input.buttons[i] = false;
-      continue;
+  if (callback) {
+    Input error_input;
+    bool error = true;
+    callback(error_input, error);
+  }
+}
+
+void InputProcessor::publish(Input& input, std::vector<ButtonEvent>* edges) {
+  std::lock_guard<std::mutex> lock(_publish_mutex);
+  input.sequence = _last_input.sequence() + 1;
+
+  // Once an edge is lost the following ones are meaningless to the consumer until it resyncs
+  auto queue_edge = [this](const ButtonEvent& event) {
+      if (_button_overflow || !_button_events.push(ButtonQueueEntry{ event, false, 0 })) {
+        _button_overflow = true;
+        _dropped_button_events.fetch_add(1, std::memory_order_relaxed);
+      }
+    };
+  ButtonMask buttons = _published_buttons;
+  if (edges) {
+    for (auto& edge : *edges) {
+      edge.sequence = input.sequence;
+      queue_edge(edge);
+      ButtonMask bit = ButtonMask{ 1 } << *magic_enum::enum_index(edge.button);
+      buttons = edge.pressed ? (buttons | bit) : (buttons & ~bit);
     }
-    auto is_pressed = std::visit(
-      [&](const auto& mapping) {
-        return mapping.parse(data, length);
-      }, *mapping);
+  }
+  for (ButtonMask bits = buttons ^ input.buttons.mask; bits != 0; bits &= bits - 1) {
+    size_t index = static_cast<size_t>(__builtin_ctz(bits));
+    queue_edge(
+      ButtonEvent{ magic_enum::enum_value<Button>(index), input.buttons[index], input.sequence,
+        input.timestamp });
+  }
+  _published_buttons = input.buttons.mask;
+  if (_button_overflow) {
+    ButtonEvent resync{ Button::Button1, false, input.sequence, input.timestamp };
+    _button_overflow = !_button_events.push(ButtonQueueEntry{ resync, true, input.buttons.mask });
+  }
 
-    if (!is_pressed.has_value()) {
-      input.buttons[i] = last_input.buttons[i];
-      continue;
+  uint64_t sequence = _last_input.write(input);
+  if (_history) {
+    _history->push(sequence, input);
+  }
+
+  // The previous values were held until this frame arrived
+  if (input.timestamp > _motion_state.time) {
+    auto held = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(input.timestamp - _motion_state.time).count());
+    for (size_t i = 0; i < AxisCount; ++i) {
+      _motion_state.raw_ns[i] += static_cast<uint64_t>(_motion_state.raw[i]) * held;
     }
-    input.buttons[i] = is_pressed.value();
+    _motion_state.time = input.timestamp;
   }
+  _motion_state.raw = input.stick.raw;
+  _motion_state.divisor = input.stick.divisor;
+  _motion.write(_motion_state);
 
-  return input;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (_waiters.load(std::memory_order_relaxed) > 0) {
+    // Taking the lock orders the notification after a waiter's predicate check
+    { std::lock_guard<std::mutex> wait_lock(_wait_mutex); }
+    _wait_cv.notify_all();
+  }
 }
 
 }  // namespace spacemouse_driver
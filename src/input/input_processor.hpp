@@ -24,19 +24,33 @@
 #include <chrono>
 #include <mutex>
 #include <condition_variable>
+#include <array>
+#include <vector>
 
-#include "util/double_buffer.hpp"
+#include "util/seqlock.hpp"
+#include "util/history_ring.hpp"
+#include "util/spsc_queue.hpp"
+#include "input/motion_integral.hpp"
 #include "spacemouse_driver/input_types.hpp"
 #include "driver/driver_context.hpp"
+#include "driver/driver_diagnostics.hpp"
 
 namespace spacemouse_driver {
 
 using DataCallback = std::function<void (const Input&, bool error)>;
 
+// Entry of the button event queue. After the queue overflowed, the edges lost are replaced by a
+// single resync entry carrying the buttons of the frame it was queued with.
+struct ButtonQueueEntry {
+  ButtonEvent event;  // Only sequence and timestamp are set in resync entries
+  bool resync;
+  ButtonMask buttons;  // Valid for resync entries
+};
+
 class InputProcessor
 {
 public:
-  explicit InputProcessor(std::shared_ptr<DriverContext> context);
+  InputProcessor(std::shared_ptr<DriverContext> context, DriverDiagnostics& diagnostics);
   ~InputProcessor();
 
   // Thread control
@@ -47,21 +61,60 @@ public:
   void set_device(std::shared_ptr<DeviceHandle> device);
   void clear_device();
 
-  // Data access
-  Input get_latest_input() const;
+  // Data access, returns the frame number of the copied input
+  uint64_t get_latest_input(Input& input) const;
+  InputHistoryRead get_input_since(uint64_t sequence, Input* frames, size_t max_frames) const;
+  // Integral extended up to now
+  MotionIntegral get_motion(std::chrono::steady_clock::time_point now) const;
+  // Button edges in the order they were reported, for a single consuming thread
+  bool pop_button_event(ButtonQueueEntry& entry);
+  // Blocks until a frame newer than last_sequence is published, returns 0 on timeout
+  uint64_t wait_for_input(
+    uint64_t last_sequence, std::chrono::milliseconds timeout,
+    Input& input) const;
 
   // Callback for new data
   void set_data_callback(DataCallback callback);
 
+  // Statistics
+  std::chrono::steady_clock::time_point get_last_report_time() const;
+  uint64_t get_repeated_report_count() const;
+  // Fills the counters owned by the input processor
+  void read_counters(DriverCounters& counters) const;
+
 private:
   std::shared_ptr<DriverContext> _context;
+  DriverDiagnostics& _diagnostics;
   std::atomic<bool> _running;
   std::thread _process_thread;
 
   // Device and data
   std::mutex _device_mutex;
+  std::condition_variable _device_cv;
   std::shared_ptr<DeviceHandle> _device;
-  DoubleBuffer<Input> _last_input;
+
+  // Latest input, written by the processing thread and by clear_device()
+  std::mutex _publish_mutex;
+  SeqLock<Input> _last_input;
+  std::unique_ptr<HistoryRing<Input>> _history;  // Null when disabled
+  MotionIntegral _motion_state;  // Guarded by _publish_mutex
+  SeqLock<MotionIntegral> _motion;
+  SpscQueue<ButtonQueueEntry> _button_events;  // Pushed under _publish_mutex
+  ButtonMask _published_buttons;  // Buttons of the last published frame, guarded by _publish_mutex
+  bool _button_overflow;  // Edges were lost and no resync entry is queued yet, guarded by _publish_mutex
+  std::atomic<uint64_t> _dropped_button_events;
+
+  // Frame updated in place by every report, only touched by the thread reading the device
+  Input _frame;
+  std::atomic<bool> _reset_frame;  // Set by clear_device(), buttons of the old device are dropped
+  // Edges found in the reports merged into _frame, touched by the thread reading the device only
+  ButtonMask _edge_buttons;
+  std::vector<ButtonEvent> _frame_edges;
+
+  // Blocked wait_for_input() callers, publish() only takes the lock when there are any
+  mutable std::mutex _wait_mutex;
+  mutable std::condition_variable _wait_cv;
+  mutable std::atomic<uint32_t> _waiters;
 
   // Config
   std::atomic<std::chrono::milliseconds> _data_timeout;
@@ -72,12 +125,45 @@ private:
 
   // Buffer for read operations
   static constexpr size_t BUFFER_SIZE = 64;
+  // Bounds a frame for devices that report faster than they are drained
+  static constexpr uint32_t MAX_MERGED_REPORTS = 32;
+  // Edges buffered for the dispatcher, covers long callback intervals
+  static constexpr size_t BUTTON_EVENT_CAPACITY = 1024;
+
+  // Last raw bytes per report ID, a report equal to the cached one cannot change the frame.
+  // Only touched by the thread reading the device.
+  struct CachedReport {
+    size_t length;
+    std::array<uint8_t, BUFFER_SIZE> data;
+  };
+  static constexpr size_t MAX_CACHED_REPORTS = 4;
+  std::array<CachedReport, MAX_CACHED_REPORTS> _report_cache;
+  std::atomic<std::chrono::steady_clock::time_point> _last_report_time;
+  std::atomic<uint64_t> _repeated_reports;
+  std::atomic<uint64_t> _reports;
+  std::atomic<uint64_t> _merged_reports;
+  std::atomic<uint64_t> _published_frames;
+  std::atomic<uint64_t> _read_errors;
+  bool is_repeated_report(const uint8_t* data, size_t length);
+
+  // Shared reactor mode: descriptor of the device watched by the reactor, -1 if none
+  int _watched_fd;
+  void watch_device(const std::shared_ptr<DeviceHandle>& device);
+  void unwatch_device();
+  void on_readable(std::shared_ptr<DeviceHandle> device);
 
   // Processing function
   void process_loop();
-
-  // Input parsing
-  Input parse(const uint8_t* data, size_t length, const DeviceConfig& config) const;
+  // Merges the report in buf with the ones queued behind it and publishes them as one frame,
+  // returns false if reading the queued reports failed
+  bool assemble_frame(
+    std::shared_ptr<DeviceHandle>& device, uint8_t* buf, int length,
+    std::chrono::steady_clock::time_point timestamp);
+  void collect_edges(std::chrono::steady_clock::time_point timestamp);
+  void handle_read_error();
+  // Publishes the frame and queues its button edges. Edges missing from the list, like the
+  // releases of a cleared frame, are derived from the previous frame.
+  void publish(Input& input, std::vector<ButtonEvent>* edges = nullptr);
 };
 
 }  // namespace spacemouse_driver
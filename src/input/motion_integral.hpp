@@ -0,0 +1,64 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "spacemouse_driver/input_types.hpp"
+
+namespace spacemouse_driver {
+
+// Running time integral of the stick axes. The sums wrap around, only differences between two
+// samples are meaningful.
+struct MotionIntegral {
+  std::array<uint64_t, AxisCount> raw_ns;  // Sum of raw value times nanoseconds it was held
+  std::array<int16_t, AxisCount> raw;  // Value held since time
+  int16_t divisor;
+  std::chrono::steady_clock::time_point time;
+};
+
+// Motion between two samples of the same integral, from being the earlier one
+inline StickMotion motion_between(const MotionIntegral& from, const MotionIntegral& to) {
+  StickMotion motion{ };
+  motion.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(to.time - from.time);
+  motion.mean.divisor = to.divisor > 0 ? to.divisor : 1;
+
+  auto duration_ns = motion.duration.count();
+  for (size_t i = 0; i < AxisCount; ++i) {
+    auto area = static_cast<int64_t>(to.raw_ns[i] - from.raw_ns[i]);
+    motion.displacement[i] = static_cast<double>(area) / motion.mean.divisor / 1e9;
+    if (duration_ns > 0) {
+      auto mean = std::llround(static_cast<double>(area) / static_cast<double>(duration_ns));
+      motion.mean.raw[i] = static_cast<int16_t>(
+        std::clamp<long long>(
+          mean, std::numeric_limits<int16_t>::min(),
+          std::numeric_limits<int16_t>::max()));
+    } else {
+      motion.mean.raw[i] = to.raw[i];
+    }
+  }
+  return motion;
+}
+
+}  // namespace spacemouse_driver
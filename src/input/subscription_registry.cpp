@@ -0,0 +1,212 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "input/subscription_registry.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace spacemouse_driver {
+
+SubscriptionRegistry::SubscriptionRegistry()
+: _next_id(1),
+  _instant_count(0) { }
+
+namespace {
+
+bool woken_by_input(const SubscriptionOptions& options) {
+  return options.delivery == Delivery::Instant && options.execution == Execution::Dispatcher;
+}
+
+}  // namespace
+
+SubscriptionRegistry::~SubscriptionRegistry() {
+  auto subscribers = _subscribers.read();
+  for (const auto& subscriber : *subscribers) {
+    subscriber->active = false;
+    if (subscriber->delivering_thread.load() != std::this_thread::get_id()) {
+      std::lock_guard<std::mutex> lock(subscriber->delivery_mutex);
+    }
+  }
+}
+
+uint64_t SubscriptionRegistry::add(std::shared_ptr<Subscriber> subscriber) {
+  subscriber->id = _next_id.fetch_add(1, std::memory_order_relaxed);
+  if (woken_by_input(subscriber->options)) {
+    _instant_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  uint64_t id = subscriber->id;
+  _subscribers.update(
+    [&subscriber](SubscriberList& list) {
+      list.push_back(std::move(subscriber));
+    });
+  return id;
+}
+
+void SubscriptionRegistry::remove(uint64_t id) {
+  std::shared_ptr<Subscriber> removed;
+  _subscribers.update(
+    [id, &removed](SubscriberList& list) {
+      auto it = std::find_if(
+        list.begin(), list.end(), [id](const auto& subscriber) {
+          return subscriber->id == id;
+        });
+      if (it != list.end()) {
+        removed = std::move(*it);
+        list.erase(it);
+      }
+    });
+  if (!removed) {
+    return;
+  }
+
+  if (woken_by_input(removed->options)) {
+    _instant_count.fetch_sub(1, std::memory_order_relaxed);
+  }
+  removed->active = false;
+  // A callback removing its own subscription cannot wait for itself
+  if (removed->delivering_thread.load() != std::this_thread::get_id()) {
+    std::lock_guard<std::mutex> lock(removed->delivery_mutex);
+  }
+}
+
+std::shared_ptr<SubscriptionRegistry::Subscriber> SubscriptionRegistry::find(uint64_t id) const {
+  auto subscribers = _subscribers.read();
+  for (const auto& subscriber : *subscribers) {
+    if (subscriber->id == id) {
+      return subscriber;
+    }
+  }
+  return nullptr;
+}
+
+void SubscriptionRegistry::Subscriber::invoke(const Input& frame, bool fresh) {
+  std::lock_guard<std::mutex> lock(delivery_mutex);
+  if (!active) {
+    return;
+  }
+
+  if (fresh) {
+    auto now = std::chrono::steady_clock::now();
+    uint64_t handoff = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - frame.timestamp).count());
+    handoff_count.fetch_add(1, std::memory_order_relaxed);
+    handoff_total_ns.fetch_add(handoff, std::memory_order_relaxed);
+    if (handoff > handoff_max_ns.load(std::memory_order_relaxed)) {
+      handoff_max_ns.store(handoff, std::memory_order_relaxed);
+    }
+  }
+  delivered.fetch_add(1, std::memory_order_relaxed);
+
+  delivering_thread = std::this_thread::get_id();
+  callback(frame);
+  delivering_thread = std::thread::id();
+}
+
+void SubscriptionRegistry::Subscriber::post(const Input& frame) {
+  {
+    std::lock_guard<std::mutex> lock(mailbox_mutex);
+    if (options.coalescing == Coalescing::Latest && !mailbox.empty()) {
+      mailbox.back() = frame;
+    } else {
+      if (mailbox.size() == MAX_MAILBOX_FRAMES) {
+        mailbox.erase(mailbox.begin());
+        dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+      mailbox.push_back(frame);
+    }
+    if (task_posted) {
+      return;
+    }
+    task_posted = true;
+  }
+
+  options.executor->execute(
+    [self = shared_from_this()] {
+      self->drain_mailbox();
+    });
+}
+
+void SubscriptionRegistry::Subscriber::drain_mailbox() {
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(mailbox_mutex);
+      if (mailbox.empty()) {
+        // Only cleared once nothing is left, so a second task never runs alongside this one
+        task_posted = false;
+        return;
+      }
+      std::swap(mailbox, draining);
+    }
+    for (const auto& frame : draining) {
+      invoke(frame, true);
+    }
+    draining.clear();
+  }
+}
+
+SubscriptionStats SubscriptionRegistry::Subscriber::stats() const {
+  uint64_t count = handoff_count.load(std::memory_order_relaxed);
+  uint64_t total = handoff_total_ns.load(std::memory_order_relaxed);
+  return SubscriptionStats{
+    delivered.load(std::memory_order_relaxed),
+    dropped.load(std::memory_order_relaxed),
+    std::chrono::nanoseconds(count > 0 ? total / count : 0),
+    std::chrono::nanoseconds(handoff_max_ns.load(std::memory_order_relaxed)),
+    jitter.stats()
+  };
+}
+
+Subscription::~Subscription() {
+  reset();
+}
+
+Subscription::Subscription(Subscription&& other) noexcept
+: _registry(std::move(other._registry)),
+  _id(std::exchange(other._id, 0)) { }
+
+Subscription& Subscription::operator=(Subscription&& other) noexcept {
+  if (this != &other) {
+    reset();
+    _registry = std::move(other._registry);
+    _id = std::exchange(other._id, 0);
+  }
+  return *this;
+}
+
+void Subscription::reset() {
+  if (_id == 0) {
+    return;
+  }
+  if (auto registry = _registry.lock()) {
+    registry->remove(_id);
+  }
+  _registry.reset();
+  _id = 0;
+}
+
+SubscriptionStats Subscription::get_stats() const {
+  auto registry = _registry.lock();
+  auto subscriber = registry ? registry->find(_id) : nullptr;
+  if (!subscriber) {
+    return SubscriptionStats{ };
+  }
+  return subscriber->stats();
+}
+
+}  // namespace spacemouse_driver
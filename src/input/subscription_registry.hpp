@@ -0,0 +1,111 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "spacemouse_driver/input_types.hpp"
+#include "spacemouse_driver/subscription.hpp"
+#include "input/motion_integral.hpp"
+#include "util/jitter_recorder.hpp"
+#include "util/rcu_pointer.hpp"
+
+namespace spacemouse_driver {
+
+// Subscribers of one driver. Owned by its CallbackDispatcher and referenced weakly by the
+// Subscription handles, so a handle outliving the driver unsubscribes from nothing.
+class SubscriptionRegistry
+{
+public:
+  struct Subscriber : std::enable_shared_from_this<Subscriber> {
+    uint64_t id;
+    SubscriptionOptions options;
+    std::function<void(const Input&)> callback;
+    std::atomic<bool> active{ true };
+
+    // Held while the callback runs, removal waits on it
+    std::mutex delivery_mutex;
+    std::atomic<std::thread::id> delivering_thread{ };
+
+    // Execution::Executor, frames waiting for the one task posted to the executor
+    std::mutex mailbox_mutex;
+    std::vector<Input> mailbox;
+    bool task_posted = false;
+    std::vector<Input> draining;  // Only touched by the posted task
+
+    // Statistics
+    std::atomic<uint64_t> delivered{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+    std::atomic<uint64_t> handoff_count{ 0 };
+    std::atomic<uint64_t> handoff_total_ns{ 0 };
+    std::atomic<uint64_t> handoff_max_ns{ 0 };
+    JitterRecorder jitter;
+
+    // Touched by the dispatching thread only
+    uint64_t last_sequence = 0;
+    std::chrono::steady_clock::time_point next_deadline{ };
+    MotionIntegral motion{ };  // Sampled on the previous delivery, Coalescing::Mean only
+
+    // Calls the callback on the calling thread, fresh frames are delivered for the first time
+    void invoke(const Input& frame, bool fresh);
+    // Hands the frame to the executor, replacing a waiting one unless every sample is delivered
+    void post(const Input& frame);
+    SubscriptionStats stats() const;
+
+private:
+    // Bounds the mailbox of Coalescing::EverySample when the executor falls behind
+    static constexpr size_t MAX_MAILBOX_FRAMES = 256;
+
+    void drain_mailbox();
+  };
+  using SubscriberList = std::vector<std::shared_ptr<Subscriber>>;
+
+  SubscriptionRegistry();
+  // Ends every subscription, tasks still queued on an executor then deliver nothing
+  ~SubscriptionRegistry();
+
+  // Assigns the subscriber its ID and publishes it
+  uint64_t add(std::shared_ptr<Subscriber> subscriber);
+  // Returns once the callback of the subscriber is neither running nor called again
+  void remove(uint64_t id);
+  std::shared_ptr<Subscriber> find(uint64_t id) const;
+
+  RcuPointer<SubscriberList>::ReadGuard subscribers() const {
+    return _subscribers.read();
+  }
+
+  // Instant subscribers served by the dispatcher, which has to wake up for every frame
+  size_t instant_count() const {
+    return _instant_count.load(std::memory_order_relaxed);
+  }
+
+private:
+  RcuPointer<SubscriberList> _subscribers;
+  std::atomic<uint64_t> _next_id;
+  std::atomic<size_t> _instant_count;
+};
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,184 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "spacemouse_driver/logger.hpp"
+
+#include <condition_variable>
+#include <cstring>
+#include <string_view>
+#include <thread>
+
+#include "util/mpsc_queue.hpp"
+
+namespace spacemouse_driver {
+
+// Preformatted messages are queued by the logging threads and written by a single background
+// thread, which is the only one touching the console streams
+class ConsoleLogger::Sink
+{
+public:
+  Sink()
+  : _queue(QUEUE_CAPACITY),
+    _running(true),
+    _sleeping(false),
+    _dropped(0) {
+    _thread = std::thread(&Sink::run, this);
+  }
+
+  ~Sink() {
+    {
+      std::lock_guard<std::mutex> lock(_wake_mutex);
+      _running = false;
+    }
+    _wake_cv.notify_one();
+    _thread.join();
+  }
+
+  void push(LogLevel level, const std::string& message) {
+    bool pushed = _queue.push(
+      [&](Record& record) {
+        record.level = level;
+        if (message.size() <= MAX_MESSAGE_LENGTH) {
+          record.length = static_cast<uint8_t>(message.size());
+          std::memcpy(record.text, message.data(), record.length);
+          return;
+        }
+        // Longer messages are cut, marked so the reader knows the rest is missing
+        size_t kept = MAX_MESSAGE_LENGTH - TRUNCATION_MARKER.size();
+        std::memcpy(record.text, message.data(), kept);
+        std::memcpy(record.text + kept, TRUNCATION_MARKER.data(), TRUNCATION_MARKER.size());
+        record.length = static_cast<uint8_t>(MAX_MESSAGE_LENGTH);
+      });
+    if (!pushed) {
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    // Pairs with the fence in run(), either the sink sees the record or this sees it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_sleeping.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(_wake_mutex);
+      _wake_cv.notify_one();
+    }
+  }
+
+private:
+  static constexpr size_t QUEUE_CAPACITY = 1024;
+  static constexpr size_t MAX_MESSAGE_LENGTH = 255;
+  static constexpr std::string_view TRUNCATION_MARKER = "...";
+
+  struct Record {
+    LogLevel level;
+    uint8_t length;
+    char text[MAX_MESSAGE_LENGTH];
+  };
+
+  MpscQueue<Record> _queue;
+  std::atomic<bool> _running;
+  std::atomic<bool> _sleeping;
+  std::atomic<uint64_t> _dropped;
+  std::mutex _wake_mutex;
+  std::condition_variable _wake_cv;
+  std::thread _thread;
+
+  void run() {
+    std::string out;
+    std::string err;
+    for (;;) {
+      bool running = _running.load();
+      write_pending(out, err);
+      if (!running) {
+        break;
+      }
+
+      std::unique_lock<std::mutex> lock(_wake_mutex);
+      _sleeping.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      _wake_cv.wait(lock, [this] {
+          return !_running || _queue.front() != nullptr;
+        });
+      _sleeping.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  // One write and flush per stream for everything queued so far
+  void write_pending(std::string& out, std::string& err) {
+    out.clear();
+    err.clear();
+    while (Record* record = _queue.front()) {
+      std::string& stream = record->level <= LogLevel::Warning ? err : out;
+      stream.append(prefix(record->level));
+      stream.append(record->text, record->length);
+      stream.push_back('\n');
+      _queue.release();
+    }
+    uint64_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+      err.append(prefix(LogLevel::Warning));
+      err.append(std::to_string(dropped) + " log messages dropped, the console could not keep up");
+      err.push_back('\n');
+    }
+
+    if (!out.empty()) {
+      std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+      std::cout.flush();
+    }
+    if (!err.empty()) {
+      std::cerr.write(err.data(), static_cast<std::streamsize>(err.size()));
+      std::cerr.flush();
+    }
+  }
+
+  static const char* prefix(LogLevel level) {
+    switch (level) {
+      case LogLevel::Error:
+        return "[ERROR] : ";
+      case LogLevel::Warning:
+        return "[WARNING] : ";
+      case LogLevel::Info:
+        return "[INFO] : ";
+      case LogLevel::Debug:
+        return "[DEBUG] : ";
+    }
+    return "";
+  }
+};
+
+ConsoleLogger::ConsoleLogger()
+: _sink(std::make_unique<Sink>()) { }
+
+ConsoleLogger::~ConsoleLogger() = default;
+
+void ConsoleLogger::log(const std::string& message, LogLevel level) {
+  if (enabled(level)) {
+    _sink->push(level, message);
+  }
+}
+
+void ConsoleLogger::warning(const std::string& message) {
+  log(message, LogLevel::Warning);
+}
+
+void ConsoleLogger::error(const std::string& message) {
+  log(message, LogLevel::Error);
+}
+
+void ConsoleLogger::debug(const std::string& message) {
+  log(message, LogLevel::Debug);
+}
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,248 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "reactor/reactor.hpp"
+
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace spacemouse_driver {
+
+Reactor::Reactor()
+: _epoll_fd(epoll_create1(EPOLL_CLOEXEC)),
+  _wake_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+  _timer_fd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)),
+  _running(false),
+  _next_timer_id(1) {
+  bool ok = _epoll_fd >= 0 && _wake_fd >= 0 && _timer_fd >= 0;
+  for (int fd : { _wake_fd, _timer_fd }) {
+    epoll_event ev{ };
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    ok = ok && epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+  }
+  if (!ok) {
+    for (int fd : { _epoll_fd, _wake_fd, _timer_fd }) {
+      if (fd >= 0) { ::close(fd); }
+    }
+    throw std::runtime_error("Failed to initialize the I/O reactor.");
+  }
+}
+
+Reactor::~Reactor() {
+  stop();
+  ::close(_timer_fd);
+  ::close(_wake_fd);
+  ::close(_epoll_fd);
+}
+
+void Reactor::start() {
+  if (_running) {
+    return;
+  }
+  _running = true;
+  _thread = std::thread(&Reactor::loop, this);
+}
+
+void Reactor::stop() {
+  if (!_running) {
+    return;
+  }
+  _running = false;
+  wake();
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+}
+
+void Reactor::add_fd(int fd, FdHandler handler, uint32_t events) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  epoll_event ev{ };
+  ev.events = events;
+  ev.data.fd = fd;
+  if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+    throw std::runtime_error("Failed to register a descriptor with the I/O reactor.");
+  }
+  _fd_handlers[fd] = std::make_shared<FdHandler>(std::move(handler));
+}
+
+void Reactor::remove_fd(int fd) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_fd_handlers.erase(fd) == 0) {
+      return;
+    }
+    // Fails harmlessly when the descriptor has already been closed
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+  }
+  wait_for_running_handler();
+}
+
+Reactor::TimerId Reactor::add_timer(Clock::time_point deadline, TimerHandler handler) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  TimerId id = _next_timer_id++;
+  _timers[id] = Timer{ deadline, std::make_shared<TimerHandler>(std::move(handler)), false };
+  arm_timer_locked();
+  return id;
+}
+
+void Reactor::reschedule_timer(TimerId id, Clock::time_point deadline) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto it = _timers.find(id);
+  if (it == _timers.end()) {
+    return;
+  }
+  it->second.deadline = deadline;
+  it->second.rescheduled = true;
+  arm_timer_locked();
+}
+
+void Reactor::cancel_timer(TimerId id) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_timers.erase(id) == 0) {
+      return;
+    }
+  }
+  wait_for_running_handler();
+}
+
+bool Reactor::in_reactor_thread() const {
+  return std::this_thread::get_id() == _thread.get_id();
+}
+
+void Reactor::loop() {
+  epoll_event events[16];
+
+  while (_running) {
+    int count = epoll_wait(_epoll_fd, events, 16, -1);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+
+    for (int i = 0; i < count && _running; ++i) {
+      int fd = events[i].data.fd;
+      if (fd == _wake_fd || fd == _timer_fd) {
+        uint64_t value;
+        [[maybe_unused]] ssize_t drained = ::read(fd, &value, sizeof(value));
+        continue;
+      }
+
+      std::lock_guard<std::mutex> handler_lock(_handler_mutex);
+      std::shared_ptr<FdHandler> handler;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _fd_handlers.find(fd);
+        if (it != _fd_handlers.end()) {
+          handler = it->second;
+        }
+      }
+      if (handler) {
+        (*handler)(events[i].events);
+      }
+    }
+
+    run_due_timers();
+  }
+}
+
+void Reactor::run_due_timers() {
+  auto now = Clock::now();
+  std::vector<TimerId> due;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& [id, timer] : _timers) {
+      if (timer.deadline <= now) {
+        due.push_back(id);
+      }
+    }
+  }
+
+  for (TimerId id : due) {
+    std::lock_guard<std::mutex> handler_lock(_handler_mutex);
+    std::shared_ptr<TimerHandler> handler;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto it = _timers.find(id);
+      if (it == _timers.end()) {
+        continue;
+      }
+      handler = it->second.handler;
+      it->second.rescheduled = false;
+    }
+
+    auto next = (*handler)();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _timers.find(id);
+    if (it == _timers.end()) {
+      continue;
+    }
+    if (it->second.rescheduled) {
+      if (next) {
+        it->second.deadline = std::min(it->second.deadline, *next);
+      }
+    } else if (next) {
+      it->second.deadline = *next;
+    } else {
+      _timers.erase(it);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  arm_timer_locked();
+}
+
+void Reactor::arm_timer_locked() {
+  itimerspec spec{ };
+  auto earliest = Clock::time_point::max();
+  for (const auto& [id, timer] : _timers) {
+    earliest = std::min(earliest, timer.deadline);
+  }
+  if (earliest != Clock::time_point::max()) {
+    // steady_clock counts CLOCK_MONOTONIC, a zero value would disarm the timer
+    auto ns = std::max<int64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(earliest.time_since_epoch()).count(), 1);
+    spec.it_value.tv_sec = ns / 1000000000;
+    spec.it_value.tv_nsec = ns % 1000000000;
+  }
+  timerfd_settime(_timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void Reactor::wait_for_running_handler() {
+  if (!in_reactor_thread()) {
+    std::lock_guard<std::mutex> handler_lock(_handler_mutex);
+  }
+}
+
+void Reactor::wake() noexcept {
+  uint64_t value = 1;
+  [[maybe_unused]] ssize_t written = ::write(_wake_fd, &value, sizeof(value));
+}
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,96 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/epoll.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+namespace spacemouse_driver {
+
+// Single thread multiplexing file descriptors and deadlines of every driver of a DriverManager.
+// Handlers run on the reactor thread and must not block. Removing a descriptor or cancelling a
+// timer from another thread waits until a handler that is currently running has returned, so the
+// owner can be destroyed right after; do not call them while holding a lock a handler takes.
+class Reactor
+{
+public:
+  using Clock = std::chrono::steady_clock;
+  using TimerId = uint64_t;
+  using FdHandler = std::function<void(uint32_t events)>;
+  // Returns the next deadline of the timer, or std::nullopt to remove it
+  using TimerHandler = std::function<std::optional<Clock::time_point>()>;
+
+  Reactor();
+  ~Reactor();
+
+  // Thread control
+  void start();
+  void stop();
+
+  // Descriptors, level-triggered
+  void add_fd(int fd, FdHandler handler, uint32_t events = EPOLLIN);
+  void remove_fd(int fd);
+
+  // Timers, a deadline of Clock::time_point::max() parks the timer until it is rescheduled
+  TimerId add_timer(Clock::time_point deadline, TimerHandler handler);
+  void reschedule_timer(TimerId id, Clock::time_point deadline);
+  void cancel_timer(TimerId id);
+
+  bool in_reactor_thread() const;
+
+private:
+  struct Timer {
+    Clock::time_point deadline;
+    std::shared_ptr<TimerHandler> handler;
+    bool rescheduled;  // reschedule_timer() was called while the handler ran
+  };
+
+  int _epoll_fd;
+  int _wake_fd;
+  int _timer_fd;
+
+  std::atomic_bool _running;
+  std::thread _thread;
+
+  std::mutex _mutex;
+  std::unordered_map<int, std::shared_ptr<FdHandler>> _fd_handlers;
+  std::map<TimerId, Timer> _timers;
+  TimerId _next_timer_id;
+
+  // Held while a handler runs
+  std::mutex _handler_mutex;
+
+  void loop();
+  void run_due_timers();
+  void arm_timer_locked();
+  void wait_for_running_handler();
+  void wake() noexcept;
+};
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,125 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "reactor/worker_pool.hpp"
+
+#include <utility>
+
+namespace spacemouse_driver {
+
+WorkerPool::WorkerPool(size_t thread_count)
+: _thread_count(thread_count > 0 ? thread_count : 1),
+  _running(false) { }
+
+WorkerPool::~WorkerPool() {
+  stop();
+}
+
+void WorkerPool::start() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_running) {
+    return;
+  }
+  _running = true;
+  for (size_t i = 0; i < _thread_count; ++i) {
+    _threads.emplace_back(&WorkerPool::worker_loop, this);
+  }
+}
+
+void WorkerPool::stop() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_running) {
+      return;
+    }
+    _running = false;
+  }
+  _cv.notify_all();
+  for (auto& thread : _threads) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+  _threads.clear();
+}
+
+void WorkerPool::post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _tasks.push_back(std::move(task));
+  }
+  _cv.notify_one();
+}
+
+void WorkerPool::worker_loop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _cv.wait(
+        lock, [this] {
+          return !_running || !_tasks.empty();
+        });
+      // Pending tasks are drained before stopping, owners may be waiting on them
+      if (_tasks.empty()) {
+        return;
+      }
+      task = std::move(_tasks.front());
+      _tasks.pop_front();
+    }
+    task();
+  }
+}
+
+SerialTask::SerialTask(WorkerPool& pool, std::function<void()> function)
+: _pool(pool),
+  _function(std::move(function)),
+  _pending(0) { }
+
+void SerialTask::request() {
+  if (_pending.fetch_add(1, std::memory_order_acq_rel) == 0) {
+    _pool.post([this] { run(); });
+  }
+}
+
+void SerialTask::wait_idle() {
+  std::unique_lock<std::mutex> lock(_idle_mutex);
+  _idle_cv.wait(
+    lock, [this] {
+      return _pending.load(std::memory_order_acquire) == 0;
+    });
+}
+
+void SerialTask::run() {
+  uint32_t handled = _pending.load(std::memory_order_acquire);
+  while (true) {
+    _function();
+
+    // The final decrement happens under the lock so wait_idle() cannot return, and the owner
+    // cannot destroy this object, before we are done touching it
+    std::lock_guard<std::mutex> lock(_idle_mutex);
+    uint32_t remaining = _pending.fetch_sub(handled, std::memory_order_acq_rel) - handled;
+    if (remaining == 0) {
+      _idle_cv.notify_all();
+      return;
+    }
+    handled = remaining;
+  }
+}
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,81 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace spacemouse_driver {
+
+// Fixed set of threads running tasks posted by the reactor, mostly user callbacks
+class WorkerPool
+{
+public:
+  explicit WorkerPool(size_t thread_count);
+  ~WorkerPool();
+
+  // Thread control
+  void start();
+  void stop();
+
+  void post(std::function<void()> task);
+
+private:
+  size_t _thread_count;
+  std::vector<std::thread> _threads;
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::deque<std::function<void()>> _tasks;
+  bool _running;
+
+  void worker_loop();
+};
+
+// Runs a function on a WorkerPool with at most one invocation queued or running at a time.
+// Requests made while it runs are folded into one more invocation, so the function must handle
+// everything that is pending when it is called.
+class SerialTask
+{
+public:
+  SerialTask(WorkerPool& pool, std::function<void()> function);
+
+  void request();
+
+  // Blocks until no invocation is queued or running
+  void wait_idle();
+
+private:
+  WorkerPool& _pool;
+  std::function<void()> _function;
+  std::atomic<uint32_t> _pending;
+  std::mutex _idle_mutex;
+  std::condition_variable _idle_cv;
+
+  void run();
+};
+
+}  // namespace spacemouse_driver
@@ -71,13 +71,31 @@ struct DeviceConfig {
     axis_mappings{}, button_mappings{} { }
 };
 
+// Decodes one report into frame in place, axes and buttons the report does not carry keep their
+// previous state
+using ReportParser = void (*)(const uint8_t* data, size_t length, Input& frame);
+
 struct DeviceHandle {
   hid_device* hid_handle;
+  // Descriptors owned by HidrawBackend, -1 when the device was opened through hidapi
+  int fd;
+  int wake_fd;
+  int epoll_fd;
   DeviceConfig config;
+  ReportParser parser;  // Specialized for config, selected when the device is opened
   std::string path;
 
-  DeviceHandle(hid_device* hid_dev, const DeviceConfig& conf, const std::string& dev_path)
-  : hid_handle(hid_dev), config(conf), path(dev_path) { }
+  DeviceHandle(
+    hid_device* hid_dev, const DeviceConfig& conf, ReportParser report_parser,
+    const std::string& dev_path)
+  : hid_handle(hid_dev), fd(-1), wake_fd(-1), epoll_fd(-1), config(conf), parser(report_parser),
+    path(dev_path) { }
+
+  DeviceHandle(
+    int dev_fd, int wake, int epoll, const DeviceConfig& conf, ReportParser report_parser,
+    const std::string& dev_path)
+  : hid_handle(nullptr), fd(dev_fd), wake_fd(wake), epoll_fd(epoll), config(conf),
+    parser(report_parser), path(dev_path) { }
 
   std::string get_name() const {
     return std::string(magic_enum::enum_name(config.model.value())) + " (" + path + ")";
@@ -28,8 +28,8 @@ struct BitMaskMapping {
   uint8_t byte_index;
   uint8_t bit_index;
 
-  std::optional<bool> parse(const uint8_t* data, const size_t) const {
-    if (report_id != data[0]) {
+  std::optional<bool> parse(const uint8_t* data, const size_t length) const {
+    if (report_id != data[0] || byte_index >= length) {
       return std::nullopt;
     }
     return (data[byte_index] & (1 << bit_index)) != 0;
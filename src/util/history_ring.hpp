@@ -0,0 +1,105 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "util/seqlock.hpp"
+
+namespace spacemouse_driver {
+
+// Fixed capacity history of the last frames, one writer and any number of lock-free readers.
+// Frames are numbered from 1 without gaps, the writer overwrites the oldest frame when full.
+template<typename T>
+class HistoryRing
+{
+public:
+  struct ReadResult {
+    size_t count;          // Frames copied to the output
+    uint64_t overwritten;  // Frames after the requested one that were lost before they were read
+    uint64_t last;         // Number of the last frame copied or skipped, pass it to the next read
+  };
+
+  explicit HistoryRing(size_t capacity)
+  : _capacity(capacity),
+    _slots(std::make_unique<Slot[]>(capacity)),
+    _head(0) { }
+
+  size_t capacity() const {
+    return _capacity;
+  }
+
+  // Writes must be serialized by the caller and numbered one after another
+  void push(uint64_t frame, const T& value) {
+    Slot& slot = _slots[(frame - 1) % _capacity];
+    slot.stamp.store(frame * 2 - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.value.store(value);
+    slot.stamp.store(frame * 2, std::memory_order_release);
+    _head.store(frame, std::memory_order_release);
+  }
+
+  // Copies up to max_count frames newer than since, oldest first
+  ReadResult read_since(uint64_t since, T* out, size_t max_count) const {
+    ReadResult result{ 0, 0, since };
+    uint64_t head = _head.load(std::memory_order_acquire);
+    if (head <= since) {
+      return result;
+    }
+
+    uint64_t frame = since + 1;
+    uint64_t oldest = head > _capacity ? head - _capacity + 1 : 1;
+    if (frame < oldest) {
+      result.overwritten = oldest - frame;
+      frame = oldest;
+    }
+
+    for (; frame <= head && result.count < max_count; ++frame) {
+      const Slot& slot = _slots[(frame - 1) % _capacity];
+      if (slot.stamp.load(std::memory_order_acquire) == frame * 2) {
+        slot.value.load(out[result.count]);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.stamp.load(std::memory_order_relaxed) == frame * 2) {
+          ++result.count;
+          result.last = frame;
+          continue;
+        }
+      }
+      // The writer lapped this slot while it was being read
+      ++result.overwritten;
+      result.last = frame;
+    }
+    return result;
+  }
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> stamp{ 0 };  // Twice the frame number, odd while it is being written
+    AtomicStorage<T> value;
+  };
+
+  size_t _capacity;
+  std::unique_ptr<Slot[]> _slots;
+  std::atomic<uint64_t> _head;  // Number of the last complete frame
+};
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,80 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "spacemouse_driver/statistics.hpp"
+
+namespace spacemouse_driver {
+
+// Schedule of a periodic task on absolute deadlines. Ticks are recorded by the thread running the
+// task, statistics can be read from any thread.
+class JitterRecorder
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  JitterRecorder()
+  : _ticks(0),
+    _missed(0),
+    _total_lateness_ns(0),
+    _max_lateness_ns(0) { }
+
+  // Records a tick due at deadline and dispatched at now, returns the deadline of the next one.
+  // Periods that already passed are skipped rather than dispatched in a burst.
+  Clock::time_point tick(Clock::time_point deadline, Clock::time_point now, Clock::duration period) {
+    auto lateness = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - deadline).count());
+    _ticks.fetch_add(1, std::memory_order_relaxed);
+    _total_lateness_ns.fetch_add(lateness, std::memory_order_relaxed);
+    if (lateness > _max_lateness_ns.load(std::memory_order_relaxed)) {
+      _max_lateness_ns.store(lateness, std::memory_order_relaxed);
+    }
+
+    auto next = deadline + period;
+    if (next <= now) {
+      auto skipped = (now - next) / period + 1;
+      _missed.fetch_add(static_cast<uint64_t>(skipped), std::memory_order_relaxed);
+      next += skipped * period;
+    }
+    return next;
+  }
+
+  JitterStats stats() const {
+    uint64_t ticks = _ticks.load(std::memory_order_relaxed);
+    uint64_t total = _total_lateness_ns.load(std::memory_order_relaxed);
+    return JitterStats{
+      ticks,
+      _missed.load(std::memory_order_relaxed),
+      std::chrono::nanoseconds(ticks > 0 ? total / ticks : 0),
+      std::chrono::nanoseconds(_max_lateness_ns.load(std::memory_order_relaxed))
+    };
+  }
+
+private:
+  std::atomic<uint64_t> _ticks;
+  std::atomic<uint64_t> _missed;
+  std::atomic<uint64_t> _total_lateness_ns;
+  std::atomic<uint64_t> _max_lateness_ns;
+};
+
+}  // namespace spacemouse_driver
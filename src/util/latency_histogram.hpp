@@ -0,0 +1,113 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "spacemouse_driver/statistics.hpp"
+
+namespace spacemouse_driver {
+
+// Log-linear histogram of durations: every power of two is split into 16 linear buckets, so a
+// bucket is at most 1/16 of its value wide. Any thread may record, a record is a few relaxed
+// atomic operations on the bucket and the maximum.
+class LatencyHistogram
+{
+public:
+  LatencyHistogram() {
+    reset();
+  }
+
+  void record(std::chrono::nanoseconds duration) {
+    auto value = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+    _buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    uint64_t max = _max.load(std::memory_order_relaxed);
+    while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) { }
+  }
+
+  // Not atomic as a whole, measurements recorded meanwhile may be partly kept
+  void reset() {
+    for (auto& bucket : _buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    _max.store(0, std::memory_order_relaxed);
+  }
+
+  LatencyPercentiles percentiles() const {
+    std::array<uint64_t, BUCKET_COUNT> counts;
+    uint64_t count = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+      counts[i] = _buckets[i].load(std::memory_order_relaxed);
+      count += counts[i];
+    }
+    if (count == 0) {
+      return LatencyPercentiles{ };
+    }
+    uint64_t max = _max.load(std::memory_order_relaxed);
+
+    // Upper bound of the bucket holding the measurement of the given rank, never above the maximum
+    auto at = [&](double quantile) {
+        auto rank = static_cast<uint64_t>(quantile * static_cast<double>(count) + 0.5);
+        rank = std::clamp<uint64_t>(rank, 1, count);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+          seen += counts[i];
+          if (seen >= rank) {
+            return std::chrono::nanoseconds(std::min(bucket_upper_bound(i), max));
+          }
+        }
+        return std::chrono::nanoseconds(max);
+      };
+
+    return LatencyPercentiles{ count, at(0.5), at(0.99), at(0.999), std::chrono::nanoseconds(max) };
+  }
+
+private:
+  static constexpr unsigned SUB_BITS = 4;
+  static constexpr uint64_t SUB_COUNT = uint64_t{ 1 } << SUB_BITS;
+  static constexpr unsigned MAX_BITS = 36;  // About 68 seconds, longer durations share the last bucket
+  static constexpr size_t BUCKET_COUNT = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+  std::array<std::atomic<uint64_t>, BUCKET_COUNT> _buckets;
+  std::atomic<uint64_t> _max;
+
+  static size_t bucket_index(uint64_t value) {
+    value = std::min(value, (uint64_t{ 1 } << MAX_BITS) - 1);
+    if (value < SUB_COUNT) {
+      return static_cast<size_t>(value);
+    }
+    unsigned shift = 63 - static_cast<unsigned>(__builtin_clzll(value)) - SUB_BITS;
+    return static_cast<size_t>((shift + 1) * SUB_COUNT + ((value >> shift) & (SUB_COUNT - 1)));
+  }
+
+  static uint64_t bucket_upper_bound(size_t index) {
+    if (index < SUB_COUNT) {
+      return index;
+    }
+    unsigned shift = static_cast<unsigned>(index / SUB_COUNT) - 1;
+    uint64_t lower = (SUB_COUNT + index % SUB_COUNT) << shift;
+    return lower + (uint64_t{ 1 } << shift) - 1;
+  }
+};
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,67 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "spacemouse_driver/logger.hpp"
+
+namespace spacemouse_driver {
+
+// Lets a single log call site through at most once per period, messages in between are only
+// counted and reported with the next one that passes
+class LogRateLimiter
+{
+public:
+  explicit LogRateLimiter(std::chrono::nanoseconds period)
+  : _period(period.count()),
+    _next_allowed(0),
+    _suppressed(0) { }
+
+  template<typename... Parts>
+  void log(Logger& logger, LogLevel level, const Parts&... parts) {
+    if (!logger.enabled(level)) {
+      return;
+    }
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t next_allowed = _next_allowed.load(std::memory_order_relaxed);
+    bool allowed = now >= next_allowed &&
+      _next_allowed.compare_exchange_strong(next_allowed, now + _period, std::memory_order_relaxed);
+    if (!allowed) {
+      _suppressed.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    uint64_t suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+    if (suppressed > 0) {
+      logger.log(level, parts..., " (", suppressed, " similar messages suppressed)");
+    } else {
+      logger.log(level, parts...);
+    }
+  }
+
+private:
+  int64_t _period;
+  std::atomic<int64_t> _next_allowed;
+  std::atomic<uint64_t> _suppressed;
+};
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,101 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "util/ring_utils.hpp"
+
+namespace spacemouse_driver {
+
+// Bounded queue with any number of producer threads and one consumer thread, push(), front() and
+// release() never block or allocate. Every slot carries a sequence number telling whether it is
+// free for the producer of that position or filled for the consumer, so producers only contend on
+// the tail index and a slow producer never exposes a half written value.
+template<typename T>
+class MpscQueue
+{
+public:
+  explicit MpscQueue(size_t capacity)
+  : _size(round_up_pow2(capacity)),
+    _slots(std::make_unique<Slot[]>(_size)),
+    _mask(_size - 1),
+    _head(0),
+    _tail(0) {
+    for (size_t i = 0; i < _size; ++i) {
+      _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Producer side, returns false if the queue is full. Fill is called with the slot to write
+  // instead of copying a finished value, so large records are written only once.
+  template<typename Fill>
+  bool push(Fill&& fill) {
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = _slots[tail & _mask];
+      auto lag = static_cast<std::ptrdiff_t>(slot.sequence.load(std::memory_order_acquire) - tail);
+      if (lag == 0) {
+        if (_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+          fill(slot.value);
+          slot.sequence.store(tail + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (lag < 0) {
+        // The slot still holds the value of the previous round
+        return false;
+      } else {
+        tail = _tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Consumer side, returns nullptr if the queue is empty. The value stays valid until release().
+  T* front() {
+    Slot& slot = _slots[_head & _mask];
+    if (slot.sequence.load(std::memory_order_acquire) != _head + 1) {
+      return nullptr;
+    }
+    return &slot.value;
+  }
+
+  // Consumer side, frees the slot returned by front()
+  void release() {
+    _slots[_head & _mask].sequence.store(_head + _size, std::memory_order_release);
+    ++_head;
+  }
+
+private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  size_t _size;
+  std::unique_ptr<Slot[]> _slots;
+  size_t _mask;
+
+  // Producers contending on the tail do not slow down the consumer's head
+  alignas(CACHE_LINE_SIZE) size_t _head;
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> _tail;
+};
+
+}  // namespace spacemouse_driver
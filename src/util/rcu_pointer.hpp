@@ -0,0 +1,165 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace spacemouse_driver {
+
+// Immutable value replaced as a whole, read-copy-update style. Readers pin the current value with
+// two atomic operations and never wait or allocate. Writers copy, modify and swap the value, and
+// never wait for readers either: replaced values are retired and freed once every reader that
+// could still see them has left, checked on later updates and when a reader leaves.
+template<typename T>
+class RcuPointer
+{
+public:
+  class ReadGuard
+  {
+public:
+    ReadGuard(const ReadGuard&) = delete;
+    ReadGuard& operator=(const ReadGuard&) = delete;
+
+    ~ReadGuard() {
+      _owner._readers[_parity].fetch_sub(1, std::memory_order_release);
+      if (_owner._retired_count.load(std::memory_order_relaxed) > 0) {
+        _owner.try_reclaim();
+      }
+    }
+
+    const T* operator->() const {
+      return _value;
+    }
+
+    const T& operator*() const {
+      return *_value;
+    }
+
+private:
+    friend class RcuPointer;
+
+    explicit ReadGuard(const RcuPointer& owner)
+    : _owner(owner),
+      _parity(owner._epoch.load(std::memory_order_seq_cst) & 1) {
+      _owner._readers[_parity].fetch_add(1, std::memory_order_seq_cst);
+      _value = _owner._current.load(std::memory_order_seq_cst);
+    }
+
+    const RcuPointer& _owner;
+    size_t _parity;
+    const T* _value;
+  };
+
+  RcuPointer()
+  : _current(new T()),
+    _epoch(0),
+    _retired_count(0),
+    _quiescent_epoch(0) {
+    _readers[0] = 0;
+    _readers[1] = 0;
+  }
+
+  ~RcuPointer() {
+    // No reader can be left once the owner is destroyed
+    delete _current.load();
+    for (auto& retired : _retired) {
+      delete retired.value;
+    }
+  }
+
+  RcuPointer(const RcuPointer&) = delete;
+  RcuPointer& operator=(const RcuPointer&) = delete;
+
+  ReadGuard read() const {
+    return ReadGuard(*this);
+  }
+
+  // Publishes a modified copy of the current value
+  template<typename Modify>
+  void update(Modify&& modify) {
+    std::lock_guard<std::mutex> lock(_writer_mutex);
+    auto next = std::make_unique<T>(*_current.load(std::memory_order_relaxed));
+    modify(*next);
+    T* previous = _current.exchange(next.release(), std::memory_order_seq_cst);
+    _retired.push_back(Retired{ previous, _epoch.load(std::memory_order_relaxed) });
+    _retired_count.store(_retired.size(), std::memory_order_relaxed);
+    reclaim_locked();
+  }
+
+private:
+  struct Retired {
+    T* value;
+    uint64_t epoch;  // Epoch at which the value was replaced
+  };
+
+  std::atomic<T*> _current;
+  // New readers register in the counter selected by the epoch parity
+  mutable std::array<std::atomic<uint32_t>, 2> _readers;
+  mutable std::atomic<uint64_t> _epoch;
+  mutable std::atomic<size_t> _retired_count;
+
+  mutable std::mutex _writer_mutex;
+  mutable std::vector<Retired> _retired;
+  mutable uint64_t _quiescent_epoch;  // Readers registered before this epoch began have all left
+
+  void try_reclaim() const {
+    std::unique_lock<std::mutex> lock(_writer_mutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+      reclaim_locked();
+    }
+  }
+
+  // A value is unreachable once two epoch flips have been followed by the counter of the parity
+  // left behind dropping to zero. The second flip catches readers that loaded the epoch before
+  // the first flip but registered after its counter was checked.
+  void reclaim_locked() const {
+    while (!_retired.empty()) {
+      uint64_t epoch = _epoch.load(std::memory_order_relaxed);
+      if (_quiescent_epoch < epoch) {
+        if (_readers[(epoch - 1) & 1].load(std::memory_order_seq_cst) != 0) {
+          break;
+        }
+        _quiescent_epoch = epoch;
+      }
+
+      size_t kept = 0;
+      for (auto& retired : _retired) {
+        if (retired.epoch + 2 <= _quiescent_epoch) {
+          delete retired.value;
+        } else {
+          _retired[kept++] = retired;
+        }
+      }
+      _retired.resize(kept);
+
+      if (!_retired.empty()) {
+        _epoch.store(epoch + 1, std::memory_order_seq_cst);
+      }
+    }
+    _retired_count.store(_retired.size(), std::memory_order_relaxed);
+  }
+};
+
+}  // namespace spacemouse_driver
@@ -0,0 +1,110 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace spacemouse_driver {
+
+// Storage of a trivially copyable value as relaxed atomic words, so a copy racing with a write
+// is well defined and only its consistency has to be checked by the caller
+template<typename T>
+class AtomicStorage
+{
+  static_assert(std::is_trivially_copyable_v<T>, "AtomicStorage requires a trivially copyable type");
+
+public:
+  AtomicStorage() {
+    store(T{ });
+  }
+
+  void store(const T& value) {
+    std::array<uint64_t, WORD_COUNT> words{ };
+    std::memcpy(words.data(), &value, sizeof(T));
+    for (size_t i = 0; i < WORD_COUNT; ++i) {
+      _words[i].store(words[i], std::memory_order_relaxed);
+    }
+  }
+
+  void load(T& value) const {
+    std::array<uint64_t, WORD_COUNT> words;
+    for (size_t i = 0; i < WORD_COUNT; ++i) {
+      words[i] = _words[i].load(std::memory_order_relaxed);
+    }
+    std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+  }
+
+private:
+  static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+  std::array<std::atomic<uint64_t>, WORD_COUNT> _words;
+};
+
+// Single writer, multiple reader snapshot. Every write publishes a new frame numbered from 1,
+// readers never block the writer and retry until they copied a frame that was not overwritten
+// in the meantime. Writes must be serialized by the caller.
+template<typename T>
+class SeqLock
+{
+public:
+  SeqLock()
+  : _sequence(0) { }
+
+  // Returns the number of the published frame
+  uint64_t write(const T& value) {
+    uint64_t seq = _sequence.load(std::memory_order_relaxed);
+    _sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _storage.store(value);
+    _sequence.store(seq + 2, std::memory_order_release);
+    return (seq + 2) / 2;
+  }
+
+  // Returns the number of the copied frame, 0 if nothing was written yet
+  uint64_t read(T& value) const {
+    while (true) {
+      uint64_t before = _sequence.load(std::memory_order_acquire);
+      if (before & 1) {
+        // Writer is in the middle of a frame
+        std::this_thread::yield();
+        continue;
+      }
+      _storage.load(value);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (_sequence.load(std::memory_order_relaxed) == before) {
+        return before / 2;
+      }
+    }
+  }
+
+  uint64_t sequence() const {
+    return _sequence.load(std::memory_order_acquire) / 2;
+  }
+
+private:
+  std::atomic<uint64_t> _sequence;  // Twice the frame number, odd while a write is in progress
+  AtomicStorage<T> _storage;
+};
+
+}  // namespace spacemouse_driver
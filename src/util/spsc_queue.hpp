@@ -0,0 +1,83 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "util/ring_utils.hpp"
+
+namespace spacemouse_driver {
+
+// Bounded queue with one producer and one consumer thread, push() and pop() never block or
+// allocate. Each side caches the index of the other one and only reloads it when the queue
+// looks full or empty.
+template<typename T>
+class SpscQueue
+{
+public:
+  explicit SpscQueue(size_t capacity)
+  : _slots(round_up_pow2(capacity)),
+    _mask(_slots.size() - 1),
+    _head(0),
+    _cached_tail(0),
+    _tail(0),
+    _cached_head(0) { }
+
+  // Producer side, returns false if the queue is full
+  bool push(const T& value) {
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail - _cached_head == _slots.size()) {
+      _cached_head = _head.load(std::memory_order_acquire);
+      if (tail - _cached_head == _slots.size()) {
+        return false;
+      }
+    }
+    _slots[tail & _mask] = value;
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side, returns false if the queue is empty
+  bool pop(T& value) {
+    size_t head = _head.load(std::memory_order_relaxed);
+    if (head == _cached_tail) {
+      _cached_tail = _tail.load(std::memory_order_acquire);
+      if (head == _cached_tail) {
+        return false;
+      }
+    }
+    value = _slots[head & _mask];
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  std::vector<T> _slots;
+  size_t _mask;
+
+  // Consumer and producer state on separate cache lines
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> _head;
+  size_t _cached_tail;
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> _tail;
+  size_t _cached_head;
+};
+
+}  // namespace spacemouse_driver
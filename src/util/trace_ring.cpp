@@ -0,0 +1,84 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "util/trace_ring.hpp"
+
+#include <fstream>
+#include <vector>
+
+#include "util/ring_utils.hpp"
+
+namespace spacemouse_driver {
+
+namespace {
+
+// File layout: magic, format version, event count, then per event the timestamp in nanoseconds
+// and the payload word, all little endian
+constexpr char TRACE_MAGIC[8] = { 'S', 'M', 'T', 'R', 'A', 'C', 'E', '\0' };
+constexpr uint32_t TRACE_VERSION = 1;
+
+void write_le(std::ofstream& file, uint64_t value, size_t bytes) {
+  char buf[8];
+  for (size_t i = 0; i < bytes; ++i) {
+    buf[i] = static_cast<char>(value >> (8 * i));
+  }
+  file.write(buf, static_cast<std::streamsize>(bytes));
+}
+
+}  // namespace
+
+TraceRing::TraceRing(size_t capacity)
+: _size(round_up_pow2(capacity)),
+  _mask(_size - 1),
+  _slots(std::make_unique<Slot[]>(_size)),
+  _next(0) { }
+
+bool TraceRing::dump(const std::string& path) const {
+  uint64_t end = _next.load(std::memory_order_acquire);
+  uint64_t begin = end > _size ? end - _size : 0;
+
+  std::vector<std::pair<uint64_t, uint64_t>> events;
+  events.reserve(static_cast<size_t>(end - begin));
+  for (uint64_t i = begin; i < end; ++i) {
+    const Slot& slot = _slots[i & _mask];
+    uint64_t timestamp = slot.timestamp_ns.load(std::memory_order_acquire);
+    uint64_t payload = slot.payload.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // Skips slots still being written or overwritten while reading
+    if (timestamp == 0 || slot.timestamp_ns.load(std::memory_order_relaxed) != timestamp) {
+      continue;
+    }
+    events.emplace_back(timestamp, payload);
+  }
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return false;
+  }
+  file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+  write_le(file, TRACE_VERSION, 4);
+  write_le(file, events.size(), 4);
+  for (const auto& [timestamp, payload] : events) {
+    write_le(file, timestamp, 8);
+    write_le(file, payload, 8);
+  }
+  file.close();
+  return !file.fail();
+}
+
+}  // namespace spacemouse_driver
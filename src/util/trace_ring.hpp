@@ -0,0 +1,93 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace spacemouse_driver {
+
+// Values are part of the dump format read by tools/trace_to_chrome.py
+enum class TraceEvent : uint16_t
+{
+  ReadReturned = 1,   // First report of a frame read, arg: report length
+  ParseDone = 2,      // All merged reports parsed, arg: reports | repeated reports << 16
+  Published = 3,      // Frame visible to readers, arg: frame sequence
+  ReadError = 4,      // Read failed, the device is treated as disconnected
+  DispatchWake = 5,   // Interval callbacks woke up, arg: lateness in microseconds
+  CallbackBegin = 6,  // arg: 0 for driver callbacks, subscription id otherwise
+  CallbackEnd = 7,    // arg: as CallbackBegin
+  Connected = 8,
+  Disconnected = 9,
+};
+
+// Fixed size ring of compact binary events, always on. Recording is a timestamp, an atomic
+// increment and two relaxed stores, any thread may record. The oldest events are overwritten.
+class TraceRing
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit TraceRing(size_t capacity);
+
+  void record(TraceEvent event, uint32_t arg = 0) {
+    record(event, arg, Clock::now());
+  }
+
+  // For events whose time was already taken
+  void record(TraceEvent event, uint32_t arg, Clock::time_point timestamp) {
+    uint64_t index = _next.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = _slots[index & _mask];
+    // A reader seeing a changed timestamp around the payload skips the slot as torn
+    slot.timestamp_ns.store(0, std::memory_order_relaxed);
+    slot.payload.store(
+      arg | static_cast<uint64_t>(event) << 32 | static_cast<uint64_t>(thread_index()) << 48,
+      std::memory_order_release);
+    slot.timestamp_ns.store(
+      static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count()),
+      std::memory_order_release);
+  }
+
+  // Writes the recorded events, oldest first, returns false if the file could not be written
+  bool dump(const std::string& path) const;
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> timestamp_ns{ 0 };  // 0 while empty or being written
+    std::atomic<uint64_t> payload{ 0 };       // arg | event << 32 | thread << 48
+  };
+
+  size_t _size;
+  size_t _mask;
+  std::unique_ptr<Slot[]> _slots;
+  std::atomic<uint64_t> _next;
+
+  // Small process wide thread numbers, so the thread fits the event word
+  static uint16_t thread_index() {
+    static std::atomic<uint16_t> next_index{ 1 };
+    thread_local uint16_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+    return index;
+  }
+};
+
+}  // namespace spacemouse_driver
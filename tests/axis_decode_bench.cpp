@@ -0,0 +1,99 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Cost of decoding the axes of a SpaceMouse Enterprise report: per axis as before the block
+// decode, as one scalar block, as one SSE2 block, and the whole report through its parser
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "device/report_parser.hpp"
+
+using namespace spacemouse_driver;
+
+namespace {
+
+constexpr size_t ITERATIONS = 20000000;
+constexpr size_t REPORT_LENGTH = 13;
+constexpr size_t ENTERPRISE = 0;
+
+}  // namespace
+
+int main() {
+  const DeviceConfig& config = DeviceRegistry::DEVICES[ENTERPRISE];
+  std::array<uint16_t, 8> invert_mask{ };
+  for (size_t i = 0; i < AxisCount; ++i) {
+    invert_mask[i] = config.axis_mappings[i].invert ? 0xFFFF : 0;
+  }
+
+  // Random axis reports, more than fit in L1 would only measure cache misses
+  std::mt19937 rng(13);
+  std::vector<std::array<uint8_t, REPORT_LENGTH>> reports(1024);
+  for (auto& report : reports) {
+    report[0] = config.axis_mappings[0].report_id;
+    for (size_t i = 1; i < REPORT_LENGTH; ++i) {
+      report[i] = static_cast<uint8_t>(rng());
+    }
+  }
+  auto report = [&](size_t i) {
+      return reports[i % reports.size()].data();
+    };
+
+  std::array<int16_t, AxisCount> out{ };
+  double per_axis = test::measure_ns(
+    ITERATIONS, [&](size_t i) {
+      for (size_t axis = 0; axis < AxisCount; ++axis) {
+        auto raw = config.axis_mappings[axis].parse(report(i), REPORT_LENGTH);
+        if (raw) { out[axis] = *raw; }
+      }
+      test::do_not_optimize(out);
+    });
+  double scalar = test::measure_ns(
+    ITERATIONS, [&](size_t i) {
+      report_parser::decode_axis_words_scalar(report(i) + 1, invert_mask, out);
+      test::do_not_optimize(out);
+    });
+  double block = test::measure_ns(
+    ITERATIONS, [&](size_t i) {
+      report_parser::decode_axis_words(report(i) + 1, invert_mask, out);
+      test::do_not_optimize(out);
+    });
+
+  ReportParser parser = get_report_parser(config.vid, config.pid);
+  CHECK(parser != nullptr);
+  Input frame{ };
+  double parse = test::measure_ns(
+    ITERATIONS, [&](size_t i) {
+      parser(report(i), REPORT_LENGTH, frame);
+      test::do_not_optimize(frame);
+    });
+
+  std::printf("per axis:     %5.2f ns\n", per_axis);
+  std::printf("scalar block: %5.2f ns\n", scalar);
+#if defined(__SSE2__)
+  std::printf("sse2 block:   %5.2f ns\n", block);
+#else
+  std::printf("block:        %5.2f ns (sse2 not built)\n", block);
+#endif
+  std::printf("full parse:   %5.2f ns\n", parse);
+  return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// The block decoders against the per-axis AxisMapping::parse() they replaced, on random reports
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+#include "test_utils.hpp"
+#include "device/report_parser.hpp"
+
+using namespace spacemouse_driver;
+
+namespace {
+
+constexpr size_t REPORT_COUNT = 100000;
+constexpr uint8_t REPORT_ID = 0x01;
+constexpr size_t REPORT_LENGTH = 1 + 2 * AxisCount;
+
+void check_report(const std::array<uint8_t, REPORT_LENGTH>& report, const std::array<uint16_t, 8>& invert_mask) {
+  std::array<int16_t, AxisCount> expected{ };
+  for (size_t i = 0; i < AxisCount; ++i) {
+    AxisMapping mapping{ magic_enum::enum_value<Axis>(i), REPORT_ID, static_cast<uint8_t>(1 + 2 * i),
+      static_cast<uint8_t>(2 + 2 * i), invert_mask[i] != 0 };
+    expected[i] = *mapping.parse(report.data(), report.size());
+  }
+
+  std::array<int16_t, AxisCount> scalar{ };
+  report_parser::decode_axis_words_scalar(report.data() + 1, invert_mask, scalar);
+  CHECK(scalar == expected);
+
+  // SSE2 when the build targets it, the scalar version again otherwise
+  std::array<int16_t, AxisCount> block{ };
+  report_parser::decode_axis_words(report.data() + 1, invert_mask, block);
+  CHECK(block == expected);
+}
+
+}  // namespace
+
+int main() {
+  std::mt19937 rng(13);
+  std::array<uint8_t, REPORT_LENGTH> report{ };
+  std::array<uint16_t, 8> invert_mask{ };
+
+  for (size_t n = 0; n < REPORT_COUNT; ++n) {
+    report[0] = REPORT_ID;
+    for (size_t i = 1; i < REPORT_LENGTH; ++i) {
+      report[i] = static_cast<uint8_t>(rng());
+    }
+    uint32_t inverted = rng();
+    for (size_t i = 0; i < AxisCount; ++i) {
+      invert_mask[i] = (inverted >> i) & 1 ? 0xFFFF : 0;
+    }
+    check_report(report, invert_mask);
+  }
+
+  // Extremes, -32768 negates to itself
+  for (uint16_t word : { 0x0000, 0x0001, 0x7FFF, 0x8000, 0x8001, 0xFFFF }) {
+    for (size_t i = 0; i < AxisCount; ++i) {
+      report[1 + 2 * i] = static_cast<uint8_t>(word);
+      report[2 + 2 * i] = static_cast<uint8_t>(word >> 8);
+      invert_mask[i] = i % 2 ? 0xFFFF : 0;
+    }
+    check_report(report, invert_mask);
+  }
+
+#if defined(__SSE2__)
+  std::printf("axis_decode: sse2 and scalar match\n");
+#else
+  std::printf("axis_decode: scalar matches, sse2 not built\n");
+#endif
+  return 0;
+}
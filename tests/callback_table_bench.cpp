@@ -0,0 +1,145 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Dispatch throughput while another thread keeps re-registering callbacks, comparing the
+// RcuPointer snapshot used by CallbackDispatcher with the mutex and copy it replaced
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "test_utils.hpp"
+#include "util/rcu_pointer.hpp"
+
+using namespace spacemouse_driver;
+
+namespace {
+
+constexpr auto DURATION = std::chrono::seconds(1);
+constexpr size_t BUTTON_COUNT = 32;
+
+// Same shape as CallbackDispatcher::CallbackTable
+struct CallbackTable {
+  std::function<void(int)> stick;
+  std::array<std::function<void(bool)>, BUTTON_COUNT> buttons;
+};
+
+std::atomic<uint64_t> sink(0);
+
+CallbackTable make_table() {
+  CallbackTable table;
+  table.stick = [](int value) {
+      sink.fetch_add(static_cast<uint64_t>(value), std::memory_order_relaxed);
+    };
+  for (auto& button : table.buttons) {
+    button = [](bool pressed) {
+        sink.fetch_add(pressed, std::memory_order_relaxed);
+      };
+  }
+  return table;
+}
+
+// Runs dispatch on the calling thread and reregister on another one for DURATION, returns the
+// number of dispatches per second
+template<typename Dispatch, typename Reregister>
+double run(Dispatch&& dispatch, Reregister&& reregister) {
+  std::atomic<bool> done(false);
+  uint64_t updates = 0;
+  std::thread writer(
+    [&] {
+      while (!done.load(std::memory_order_relaxed)) {
+        reregister(updates++);
+      }
+    });
+
+  uint64_t dispatches = 0;
+  auto start = std::chrono::steady_clock::now();
+  auto end = start + DURATION;
+  auto now = start;
+  while (now < end) {
+    for (int i = 0; i < 1000; ++i) {
+      dispatch(dispatches++);
+    }
+    now = std::chrono::steady_clock::now();
+  }
+  done = true;
+  writer.join();
+  CHECK(updates > 0);
+
+  std::chrono::duration<double> elapsed = now - start;
+  return static_cast<double>(dispatches) / elapsed.count();
+}
+
+double run_rcu() {
+  RcuPointer<CallbackTable> callbacks;
+  callbacks.update(
+    [](CallbackTable& table) {
+      table = make_table();
+    });
+  return run(
+    [&](uint64_t i) {
+      auto table = callbacks.read();
+      table->stick(1);
+      table->buttons[i % BUTTON_COUNT](true);
+    }, [&](uint64_t i) {
+      callbacks.update(
+        [i](CallbackTable& table) {
+          table.buttons[i % BUTTON_COUNT] = [](bool pressed) {
+              sink.fetch_add(pressed, std::memory_order_relaxed);
+            };
+        });
+    });
+}
+
+// Dispatch path before the snapshot: lock, copy the callback, unlock, call
+double run_mutex() {
+  std::mutex mutex;
+  CallbackTable callbacks = make_table();
+  return run(
+    [&](uint64_t i) {
+      std::function<void(int)> stick;
+      std::function<void(bool)> button;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stick = callbacks.stick;
+        button = callbacks.buttons[i % BUTTON_COUNT];
+      }
+      stick(1);
+      button(true);
+    }, [&](uint64_t i) {
+      std::lock_guard<std::mutex> lock(mutex);
+      callbacks.buttons[i % BUTTON_COUNT] = [](bool pressed) {
+          sink.fetch_add(pressed, std::memory_order_relaxed);
+        };
+    });
+}
+
+}  // namespace
+
+int main() {
+  double rcu = run_rcu();
+  double mutex = run_mutex();
+  std::printf("rcu snapshot:   %6.2fM dispatches/s\n", rcu / 1e6);
+  std::printf("mutex and copy: %6.2fM dispatches/s\n", mutex / 1e6);
+  return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "util/history_ring.hpp"
+
+using namespace spacemouse_driver;
+
+namespace {
+
+constexpr size_t READER_COUNT = 4;
+constexpr size_t CAPACITY = 64;
+constexpr uint64_t MIN_FRAMES_READ = 1000000;
+
+using Frame = test::FilledFrame<>;
+
+void test_read_since() {
+  HistoryRing<Frame> ring(4);
+  std::vector<Frame> out(8);
+
+  auto result = ring.read_since(0, out.data(), out.size());
+  CHECK(result.count == 0);
+  CHECK(result.last == 0);
+
+  for (uint64_t number = 1; number <= 3; ++number) {
+    ring.push(number, test::filled_frame(number));
+  }
+  result = ring.read_since(1, out.data(), out.size());
+  CHECK(result.count == 2);
+  CHECK(result.overwritten == 0);
+  CHECK(result.last == 3);
+  CHECK(out[0][0] == 2);
+  CHECK(out[1][0] == 3);
+
+  // Frames 1 to 6 were lost once frame 10 is written into a ring of 4
+  for (uint64_t number = 4; number <= 10; ++number) {
+    ring.push(number, test::filled_frame(number));
+  }
+  result = ring.read_since(0, out.data(), 2);
+  CHECK(result.count == 2);
+  CHECK(result.overwritten == 6);
+  CHECK(result.last == 8);
+  CHECK(out[0][0] == 7);
+  CHECK(out[1][0] == 8);
+
+  result = ring.read_since(result.last, out.data(), out.size());
+  CHECK(result.count == 2);
+  CHECK(result.overwritten == 0);
+  CHECK(result.last == 10);
+  CHECK(out[1][0] == 10);
+}
+
+void test_readers_against_writer() {
+  HistoryRing<Frame> ring(CAPACITY);
+  std::vector<uint64_t> last(READER_COUNT, 0);
+  std::vector<std::vector<Frame>> out(READER_COUNT, std::vector<Frame>(CAPACITY));
+  std::atomic<uint64_t> frames_read(0);
+  std::atomic<uint64_t> frames_lost(0);
+
+  test::run_readers_against_writer(
+    READER_COUNT, [&] {
+      auto deadline = std::chrono::steady_clock::now() + test::MAX_RACE_DURATION;
+      for (uint64_t number = 1; frames_read.load(std::memory_order_relaxed) < MIN_FRAMES_READ; ++number) {
+        ring.push(number, test::filled_frame(number));
+        if ((number & 0xfff) == 0 && std::chrono::steady_clock::now() > deadline) {
+          break;
+        }
+      }
+    }, [&](size_t reader) {
+      // Rereads the last ring full, so readers spend their time copying and a writer preempting
+      // them laps the slot being copied
+      uint64_t since = last[reader] > CAPACITY ? last[reader] - CAPACITY : 0;
+      auto result = ring.read_since(since, out[reader].data(), out[reader].size());
+      // Every frame after the requested one is either copied or counted as lost
+      CHECK(result.count + result.overwritten == result.last - since);
+      CHECK(result.last >= last[reader]);
+      uint64_t previous = since;
+      for (size_t i = 0; i < result.count; ++i) {
+        const Frame& frame = out[reader][i];
+        for (uint64_t word : frame) {
+          CHECK(word == frame[0]);
+        }
+        CHECK(frame[0] > previous);
+        CHECK(frame[0] <= result.last);
+        previous = frame[0];
+      }
+      last[reader] = result.last;
+      frames_read.fetch_add(result.count, std::memory_order_relaxed);
+      frames_lost.fetch_add(result.overwritten, std::memory_order_relaxed);
+    });
+
+  CHECK(frames_read.load() >= MIN_FRAMES_READ);
+  std::printf(
+    "history_ring: %llu frames copied, %llu overwritten before they were copied\n",
+    static_cast<unsigned long long>(frames_read.load()), static_cast<unsigned long long>(frames_lost.load()));
+}
+
+}  // namespace
+
+int main() {
+  test_read_since();
+  test_readers_against_writer();
+  return 0;
+}
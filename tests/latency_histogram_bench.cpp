@@ -0,0 +1,72 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Cost of one measurement on the hot path: the two clock reads around a stage and the record
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "util/latency_histogram.hpp"
+
+using namespace spacemouse_driver;
+
+namespace {
+
+constexpr size_t ITERATIONS = 20000000;
+
+}  // namespace
+
+int main() {
+  // Spread over many buckets like real latencies, a single hot bucket would flatter the record
+  std::mt19937_64 rng(24);
+  std::vector<std::chrono::nanoseconds> durations(4096);
+  for (auto& duration : durations) {
+    duration = std::chrono::nanoseconds(rng() >> (rng() % 60 + 4));
+  }
+
+  LatencyHistogram histogram;
+  double record = test::measure_ns(
+    ITERATIONS, [&](size_t i) {
+      histogram.record(durations[i % durations.size()]);
+    });
+  double clock = test::measure_ns(
+    ITERATIONS, [&](size_t) {
+      auto now = std::chrono::steady_clock::now();
+      test::do_not_optimize(now);
+    });
+  double measured = test::measure_ns(
+    ITERATIONS, [&](size_t) {
+      auto start = std::chrono::steady_clock::now();
+      histogram.record(std::chrono::steady_clock::now() - start);
+    });
+  double percentiles = test::measure_ns(
+    10000, [&](size_t) {
+      auto result = histogram.percentiles();
+      test::do_not_optimize(result);
+    });
+
+  std::printf("record:                %6.1f ns\n", record);
+  std::printf("steady_clock::now():   %6.1f ns\n", clock);
+  std::printf("two clock reads+record:%6.1f ns\n", measured);
+  std::printf("percentiles():         %6.1f ns\n", percentiles);
+  return 0;
+}
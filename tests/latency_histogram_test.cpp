@@ -0,0 +1,167 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "util/latency_histogram.hpp"
+
+using namespace spacemouse_driver;
+using std::chrono::nanoseconds;
+
+namespace {
+
+constexpr uint64_t MAX_VALUE = (uint64_t{ 1 } << 36) - 1;
+
+// Bucket bounds written out independently of the histogram: values below 32 are exact, above
+// that every power of two is split into 16 buckets
+uint64_t expected_upper_bound(uint64_t value) {
+  value = std::min(value, MAX_VALUE);
+  if (value < 32) {
+    return value;
+  }
+  unsigned log2 = 63 - static_cast<unsigned>(__builtin_clzll(value));
+  unsigned shift = log2 - 4;
+  return ((value >> shift) << shift) + (uint64_t{ 1 } << shift) - 1;
+}
+
+// A larger second measurement keeps the maximum from clamping the reported bound
+uint64_t reported_upper_bound(uint64_t value) {
+  LatencyHistogram histogram;
+  histogram.record(nanoseconds(value));
+  histogram.record(nanoseconds(uint64_t{ 1 } << 40));
+  return static_cast<uint64_t>(histogram.percentiles().p50.count());
+}
+
+void test_empty_and_reset() {
+  LatencyHistogram histogram;
+  LatencyPercentiles empty = histogram.percentiles();
+  CHECK(empty.count == 0);
+  CHECK(empty.max == nanoseconds(0));
+
+  histogram.record(nanoseconds(100));
+  CHECK(histogram.percentiles().count == 1);
+  histogram.reset();
+  CHECK(histogram.percentiles().count == 0);
+  CHECK(histogram.percentiles().max == nanoseconds(0));
+}
+
+void test_bucket_boundaries() {
+  std::vector<uint64_t> values;
+  for (uint64_t value = 0; value < 4096; ++value) {
+    values.push_back(value);
+  }
+  for (unsigned bit = 12; bit <= 36; ++bit) {
+    uint64_t power = uint64_t{ 1 } << bit;
+    for (uint64_t value : { power - 1, power, power + 1, power + power / 16 - 1, power + power / 16 }) {
+      values.push_back(value);
+    }
+  }
+
+  for (uint64_t value : values) {
+    uint64_t bound = reported_upper_bound(value);
+    CHECK(bound == expected_upper_bound(value));
+    CHECK(bound >= std::min(value, MAX_VALUE));
+    // A bucket is at most 1/16 of its values wide
+    CHECK((bound - std::min(value, MAX_VALUE)) * 16 <= std::max<uint64_t>(value, 1));
+  }
+  // A single measurement reports itself, the bound is clamped to the maximum
+  LatencyHistogram histogram;
+  histogram.record(nanoseconds(1000));
+  CHECK(histogram.percentiles().p50 == nanoseconds(1000));
+}
+
+void test_percentile_ranks() {
+  LatencyHistogram histogram;
+  for (uint64_t value = 1; value <= 1000; ++value) {
+    histogram.record(nanoseconds(value));
+  }
+  LatencyPercentiles result = histogram.percentiles();
+  CHECK(result.count == 1000);
+  CHECK(result.max == nanoseconds(1000));
+  // Ranks 500, 990 and 999, reported as the upper bound of their bucket
+  CHECK(result.p50 == nanoseconds(511));
+  CHECK(result.p99 == nanoseconds(991));
+  // The bucket of 999 ends at 1023, which is clamped to the maximum
+  CHECK(result.p999 == nanoseconds(1000));
+
+  // Rank rounding on small counts: the 2nd of 3, the 3rd of 3
+  LatencyHistogram small;
+  for (uint64_t value : { 10, 20, 30 }) {
+    small.record(nanoseconds(value));
+  }
+  CHECK(small.percentiles().p50 == nanoseconds(20));
+  CHECK(small.percentiles().p99 == nanoseconds(30));
+}
+
+void test_clamping() {
+  LatencyHistogram histogram;
+  // Negative durations count as zero
+  histogram.record(nanoseconds(-5));
+  CHECK(histogram.percentiles().p50 == nanoseconds(0));
+  CHECK(histogram.percentiles().max == nanoseconds(0));
+
+  // From 2^36 ns on everything shares the last bucket, the maximum stays exact
+  histogram.reset();
+  histogram.record(nanoseconds(uint64_t{ 1 } << 37));
+  histogram.record(nanoseconds(uint64_t{ 1 } << 40));
+  LatencyPercentiles result = histogram.percentiles();
+  CHECK(result.count == 2);
+  CHECK(result.p50 == nanoseconds(MAX_VALUE));
+  CHECK(result.max == nanoseconds(uint64_t{ 1 } << 40));
+  CHECK(reported_upper_bound(MAX_VALUE) == MAX_VALUE);
+  CHECK(reported_upper_bound(MAX_VALUE + 1) == MAX_VALUE);
+}
+
+void test_concurrent_records() {
+  constexpr size_t THREAD_COUNT = 4;
+  constexpr uint64_t RECORDS = 100000;
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < THREAD_COUNT; ++t) {
+    threads.emplace_back(
+      [&histogram, t] {
+        for (uint64_t i = 0; i < RECORDS; ++i) {
+          histogram.record(nanoseconds(i * THREAD_COUNT + t));
+        }
+      });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  LatencyPercentiles result = histogram.percentiles();
+  CHECK(result.count == THREAD_COUNT * RECORDS);
+  CHECK(result.max == nanoseconds(THREAD_COUNT * RECORDS - 1));
+}
+
+}  // namespace
+
+int main() {
+  test_empty_and_reset();
+  test_bucket_boundaries();
+  test_percentile_ranks();
+  test_clamping();
+  test_concurrent_records();
+  std::printf("latency_histogram: ok\n");
+  return 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "util/mpsc_queue.hpp"
+
+using namespace spacemouse_driver;
+
+namespace {
+
+constexpr size_t PRODUCER_COUNT = 4;
+constexpr uint64_t VALUES_PER_PRODUCER = 500000;
+
+// Filled in place by push(), large enough for a producer to be preempted halfway, so a record
+// visible before its producer finished shows up as mixed words
+struct Record {
+  uint64_t producer;
+  std::array<uint64_t, 512> words;
+};
+
+void fill_record(Record& record, uint64_t producer, uint64_t number) {
+  record.producer = producer;
+  record.words.fill(number);
+}
+
+void test_capacity() {
+  // Rounded up to a power of two
+  MpscQueue<Record> queue(3);
+  CHECK(queue.front() == nullptr);
+  for (uint64_t number = 0; number < 4; ++number) {
+    CHECK(
+      queue.push(
+        [number](Record& record) {
+          fill_record(record, 0, number);
+        }));
+  }
+  bool called = false;
+  CHECK(
+    !queue.push(
+      [&called](Record&) {
+        called = true;
+      }));
+  // A full queue never hands out a slot
+  CHECK(!called);
+
+  // First in, first out across several wraps of the indices
+  for (uint64_t number = 4; number < 100; ++number) {
+    Record* record = queue.front();
+    CHECK(record != nullptr);
+    CHECK(record->words[0] == number - 4);
+    // Still the same record until it is released
+    CHECK(queue.front() == record);
+    queue.release();
+    CHECK(
+      queue.push(
+        [number](Record& record) {
+          fill_record(record, 0, number);
+        }));
+  }
+  for (uint64_t number = 96; number < 100; ++number) {
+    CHECK(queue.front()->words[0] == number);
+    queue.release();
+  }
+  CHECK(queue.front() == nullptr);
+}
+
+void test_producers_against_consumer() {
+  // Large enough that producers are mostly preempted while filling a record, not while waiting for
+  // the consumer
+  MpscQueue<Record> queue(4096);
+  std::vector<std::thread> producers;
+  for (size_t producer = 0; producer < PRODUCER_COUNT; ++producer) {
+    producers.emplace_back(
+      [&queue, producer] {
+        for (uint64_t number = 0; number < VALUES_PER_PRODUCER; ++number) {
+          auto fill = [producer, number](Record& record) {
+              fill_record(record, producer, number);
+            };
+          while (!queue.push(fill)) {
+            std::this_thread::yield();
+          }
+        }
+      });
+  }
+
+  // Values of one producer keep their order, those of different producers interleave
+  std::array<uint64_t, PRODUCER_COUNT> expected{ };
+  uint64_t received = 0;
+  while (received < PRODUCER_COUNT * VALUES_PER_PRODUCER) {
+    Record* record = queue.front();
+    if (!record) {
+      std::this_thread::yield();
+      continue;
+    }
+    CHECK(record->producer < PRODUCER_COUNT);
+    for (uint64_t word : record->words) {
+      CHECK(word == expected[record->producer]);
+    }
+    ++expected[record->producer];
+    queue.release();
+    ++received;
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  CHECK(queue.front() == nullptr);
+}
+
+}  // namespace
+
+int main() {
+  test_capacity();
+  test_producers_against_consumer();
+  std::printf("mpsc_queue: ok\n");
+  return 0;
+}
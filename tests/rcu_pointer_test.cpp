@@ -0,0 +1,113 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#include "test_utils.hpp"
+#include "util/rcu_pointer.hpp"
+
+using namespace spacemouse_driver;
+
+namespace {
+
+constexpr size_t READER_COUNT = 4;
+constexpr uint64_t UPDATE_COUNT = 200000;
+
+std::atomic<int64_t> live_values(0);
+
+// Poisoned on destruction, a reader still holding a reclaimed value sees it
+struct Value {
+  uint64_t first = 0;
+  uint64_t second = 0;
+  bool alive = true;
+
+  Value() {
+    live_values.fetch_add(1);
+  }
+  Value(const Value& other)
+  : first(other.first),
+    second(other.second),
+    alive(other.alive) {
+    live_values.fetch_add(1);
+  }
+  ~Value() {
+    alive = false;
+    first = ~uint64_t{ 0 };
+    live_values.fetch_sub(1);
+  }
+};
+
+void test_update() {
+  RcuPointer<Value> pointer;
+  CHECK(pointer.read()->first == 0);
+  pointer.update(
+    [](Value& value) {
+      value.first = 1;
+    });
+  {
+    auto guard = pointer.read();
+    // A pinned value survives updates
+    pointer.update(
+      [](Value& value) {
+        value.first = 2;
+      });
+    CHECK(guard->first == 1);
+    CHECK(guard->alive);
+    CHECK(pointer.read()->first == 2);
+  }
+}
+
+void test_readers_against_writer() {
+  {
+    RcuPointer<Value> pointer;
+    test::run_readers_against_writer(
+      READER_COUNT, [&] {
+        for (uint64_t number = 1; number <= UPDATE_COUNT; ++number) {
+          pointer.update(
+            [number](Value& value) {
+              value.first = number;
+              value.second = number;
+            });
+        }
+      }, [&](size_t) {
+        auto guard = pointer.read();
+        uint64_t first = guard->first;
+        std::this_thread::yield();
+        // Still pinned after other threads ran, so neither freed nor modified
+        CHECK(guard->alive);
+        CHECK(guard->first == first);
+        CHECK(guard->second == first);
+      });
+    // Retired values are freed while the readers run, not only by the destructor
+    CHECK(live_values.load() < static_cast<int64_t>(UPDATE_COUNT / 2));
+  }
+  CHECK(live_values.load() == 0);
+}
+
+}  // namespace
+
+int main() {
+  test_update();
+  CHECK(live_values.load() == 0);
+  test_readers_against_writer();
+  std::printf("rcu_pointer: ok\n");
+  return 0;
+}
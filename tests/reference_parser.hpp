@@ -0,0 +1,58 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <variant>
+
+#include "types/device_types.hpp"
+
+namespace spacemouse_driver {
+namespace test {
+
+// Generic parse the generated parsers replaced: every mapping of the config is looked up and
+// parsed on its own. Values a report does not carry are left as they were in the frame.
+inline void reference_parse(const uint8_t* data, size_t length, const DeviceConfig& config, Input& frame) {
+  frame.stick.divisor = config.axis_div;
+  if (length == 0) {
+    return;
+  }
+
+  for (size_t i = 0; i < AxisCount; ++i) {
+    auto mapping = config.get_axis_mapping(magic_enum::enum_value<Axis>(i));
+    auto raw_data = mapping.parse(data, length);
+    if (!raw_data) { continue; }
+    frame.stick.raw[i] = *raw_data;
+  }
+
+  for (size_t i = 0; i < ButtonCount; ++i) {
+    auto mapping = config.get_button_mapping(magic_enum::enum_value<Button>(i));
+    if (!mapping) { continue; }
+    auto is_pressed = std::visit(
+      [&](const auto& mapping) {
+        return mapping.parse(data, length);
+      }, *mapping);
+    if (!is_pressed) { continue; }
+    frame.buttons.set(i, *is_pressed);
+  }
+}
+
+}  // namespace test
+}  // namespace spacemouse_driver
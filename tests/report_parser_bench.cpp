@@ -0,0 +1,90 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Per report cost of the generic parse and the generated parser, for every DeviceRegistry config
+// on an axis report and a full length button report
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "reference_parser.hpp"
+#include "device/report_parser.hpp"
+
+using namespace spacemouse_driver;
+
+namespace {
+
+constexpr size_t ITERATIONS = 2000000;
+constexpr size_t AXIS_REPORT_LENGTH = 13;
+constexpr size_t BUTTON_REPORT_LENGTH = 64;
+
+using Report = std::array<uint8_t, BUTTON_REPORT_LENGTH>;
+
+uint8_t button_report_id(const DeviceConfig& config) {
+  for (const auto& mapping : config.button_mappings) {
+    if (mapping) {
+      return static_cast<uint8_t>(report_parser::button_report_id(*mapping));
+    }
+  }
+  return 0;
+}
+
+std::vector<Report> make_reports(uint8_t report_id, std::mt19937& rng) {
+  std::vector<Report> reports(256);
+  for (auto& report : reports) {
+    for (auto& byte : report) {
+      byte = static_cast<uint8_t>(rng());
+    }
+    report[0] = report_id;
+  }
+  return reports;
+}
+
+void bench(const DeviceConfig& config, ReportParser parser, const char* name, const std::vector<Report>& reports,
+  size_t length) {
+  Input frame{ };
+  double generic = test::measure_ns(
+    ITERATIONS, [&](size_t i) {
+      test::reference_parse(reports[i % reports.size()].data(), length, config, frame);
+      test::do_not_optimize(frame);
+    });
+  double generated = test::measure_ns(
+    ITERATIONS, [&](size_t i) {
+      parser(reports[i % reports.size()].data(), length, frame);
+      test::do_not_optimize(frame);
+    });
+  std::printf("  %-14s generic %7.1f ns, generated %5.1f ns\n", name, generic, generated);
+}
+
+}  // namespace
+
+int main() {
+  std::mt19937 rng(9);
+  for (const auto& config : DeviceRegistry::DEVICES) {
+    ReportParser parser = get_report_parser(config.vid, config.pid);
+    CHECK(parser != nullptr);
+    std::printf("%04x:%04x\n", config.vid, config.pid);
+    bench(config, parser, "axis report", make_reports(config.axis_mappings[0].report_id, rng), AXIS_REPORT_LENGTH);
+    bench(config, parser, "button report", make_reports(button_report_id(config), rng), BUTTON_REPORT_LENGTH);
+  }
+  return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// The generated parser of every DeviceRegistry config against the generic parse, on random reports
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "reference_parser.hpp"
+#include "device/report_parser.hpp"
+
+using namespace spacemouse_driver;
+
+namespace {
+
+constexpr size_t REPORT_COUNT = 200000;
+constexpr size_t MAX_REPORT_LENGTH = 64;
+
+// Report IDs and byte codes the config uses, random bytes alone would rarely hit them
+struct ConfigValues {
+  std::vector<uint8_t> report_ids;
+  std::vector<uint8_t> codes;
+};
+
+ConfigValues collect_values(const DeviceConfig& config) {
+  ConfigValues values;
+  for (const auto& mapping : config.axis_mappings) {
+    values.report_ids.push_back(mapping.report_id);
+  }
+  for (const auto& mapping : config.button_mappings) {
+    if (!mapping) { continue; }
+    if (std::holds_alternative<BitMaskMapping>(*mapping)) {
+      values.report_ids.push_back(std::get<BitMaskMapping>(*mapping).report_id);
+    } else {
+      values.report_ids.push_back(std::get<ByteCodeMapping>(*mapping).report_id);
+      values.codes.push_back(std::get<ByteCodeMapping>(*mapping).code);
+    }
+  }
+  return values;
+}
+
+void test_config(size_t index, std::mt19937& rng) {
+  const DeviceConfig& config = DeviceRegistry::DEVICES[index];
+  ReportParser parser = get_report_parser(config.vid, config.pid);
+  CHECK(parser == report_parser::PARSERS[index]);
+  ConfigValues values = collect_values(config);
+
+  std::array<uint8_t, MAX_REPORT_LENGTH> report{ };
+  for (size_t n = 0; n < REPORT_COUNT; ++n) {
+    // Mostly IDs of the config, sometimes an unknown one which must leave the frame alone
+    size_t length = rng() % (MAX_REPORT_LENGTH + 1);
+    for (auto& byte : report) {
+      byte = static_cast<uint8_t>(rng());
+    }
+    if (rng() % 8 != 0) {
+      report[0] = values.report_ids[rng() % values.report_ids.size()];
+    }
+    if (!values.codes.empty()) {
+      for (size_t i = 1; i < length; ++i) {
+        if (rng() % 4 == 0) {
+          report[i] = values.codes[rng() % values.codes.size()];
+        }
+      }
+    }
+
+    // Both start from the same frame, reports only update part of it
+    Input expected{ };
+    for (auto& raw : expected.stick.raw) {
+      raw = static_cast<int16_t>(rng());
+    }
+    expected.buttons.mask = static_cast<ButtonMask>(rng());
+    Input parsed = expected;
+
+    test::reference_parse(report.data(), length, config, expected);
+    parser(report.data(), length, parsed);
+    CHECK(parsed.stick.raw == expected.stick.raw);
+    CHECK(parsed.stick.divisor == expected.stick.divisor);
+    CHECK(parsed.buttons.mask == expected.buttons.mask);
+  }
+}
+
+}  // namespace
+
+int main() {
+  std::mt19937 rng(9);
+  for (size_t i = 0; i < DeviceRegistry::DEVICES.size(); ++i) {
+    test_config(i, rng);
+  }
+  CHECK(get_report_parser(0, 0) == nullptr);
+  std::printf("report_parser: %zu configs match the generic parse\n", DeviceRegistry::DEVICES.size());
+  return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "util/seqlock.hpp"
+
+using namespace spacemouse_driver;
+
+namespace {
+
+constexpr size_t READER_COUNT = 4;
+// Enough to cross scheduler time slices even when readers and writer share a core
+constexpr uint64_t MIN_RACING_READS = 100000;
+
+using Frame = test::FilledFrame<>;
+
+void test_sequence() {
+  SeqLock<Frame> lock;
+  Frame frame = test::filled_frame(7);
+  CHECK(lock.sequence() == 0);
+  CHECK(lock.read(frame) == 0);
+  CHECK(frame[0] == 0);
+
+  CHECK(lock.write(test::filled_frame(1)) == 1);
+  CHECK(lock.write(test::filled_frame(2)) == 2);
+  CHECK(lock.sequence() == 2);
+  CHECK(lock.read(frame) == 2);
+  CHECK(frame.back() == 2);
+}
+
+void test_torn_reads() {
+  SeqLock<Frame> lock;
+  std::vector<uint64_t> last_sequence(READER_COUNT, 0);
+  std::atomic<uint64_t> racing_reads(0);
+
+  test::run_readers_against_writer(
+    READER_COUNT, [&] {
+      auto deadline = std::chrono::steady_clock::now() + test::MAX_RACE_DURATION;
+      for (uint64_t number = 1; racing_reads.load(std::memory_order_relaxed) < MIN_RACING_READS; ++number) {
+        CHECK(lock.write(test::filled_frame(number)) == number);
+        if ((number & 0xfff) == 0 && std::chrono::steady_clock::now() > deadline) {
+          break;
+        }
+      }
+    }, [&](size_t reader) {
+      Frame frame;
+      uint64_t sequence = lock.read(frame);
+      // Anything but the read frame's number in every word was copied while being overwritten
+      for (uint64_t word : frame) {
+        CHECK(word == sequence);
+      }
+      CHECK(sequence >= last_sequence[reader]);
+      last_sequence[reader] = sequence;
+      if (sequence > 0) {
+        racing_reads.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+
+  // Without reads during the writes the test proves nothing
+  CHECK(racing_reads.load() >= MIN_RACING_READS);
+  std::printf(
+    "seqlock: %llu reads raced with %llu writes\n", static_cast<unsigned long long>(racing_reads.load()),
+    static_cast<unsigned long long>(lock.sequence()));
+}
+
+}  // namespace
+
+int main() {
+  test_sequence();
+  test_torn_reads();
+  return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#include "test_utils.hpp"
+#include "util/spsc_queue.hpp"
+
+using namespace spacemouse_driver;
+
+namespace {
+
+constexpr uint64_t VALUE_COUNT = 2000000;
+
+// Smaller than the default frame, so the large queue below stays a reasonable size
+constexpr size_t VALUE_WORDS = 128;
+using Value = test::FilledFrame<VALUE_WORDS>;
+
+void test_capacity() {
+  // Rounded up to a power of two
+  SpscQueue<Value> queue(5);
+  for (uint64_t number = 0; number < 8; ++number) {
+    CHECK(queue.push(test::filled_frame<VALUE_WORDS>(number)));
+  }
+  CHECK(!queue.push(test::filled_frame<VALUE_WORDS>(8)));
+
+  // First in, first out across several wraps of the indices
+  Value value;
+  for (uint64_t number = 8; number < 100; ++number) {
+    CHECK(queue.pop(value));
+    CHECK(value[0] == number - 8);
+    CHECK(queue.push(test::filled_frame<VALUE_WORDS>(number)));
+  }
+  for (uint64_t number = 92; number < 100; ++number) {
+    CHECK(queue.pop(value));
+    CHECK(value[0] == number);
+  }
+  CHECK(!queue.pop(value));
+}
+
+void test_producer_against_consumer() {
+  // Large enough that the producer rarely finds it full and is preempted in the middle of a push
+  // rather than when it yields
+  SpscQueue<Value> queue(32768);
+  uint64_t expected = 0;
+  auto check = [&](const Value& value) {
+      for (uint64_t word : value) {
+        CHECK(word == expected);
+      }
+      ++expected;
+    };
+
+  test::run_readers_against_writer(
+    1, [&] {
+      for (uint64_t number = 0; number < VALUE_COUNT; ++number) {
+        while (!queue.push(test::filled_frame<VALUE_WORDS>(number))) {
+          std::this_thread::yield();
+        }
+      }
+    }, [&](size_t) {
+      Value value;
+      while (queue.pop(value)) {
+        check(value);
+      }
+      // Lets the producer refill the queue instead of spinning on it empty
+      std::this_thread::yield();
+    });
+
+  // Values pushed after the consumer's last pop
+  Value value;
+  while (queue.pop(value)) {
+    check(value);
+  }
+  CHECK(expected == VALUE_COUNT);
+}
+
+}  // namespace
+
+int main() {
+  test_capacity();
+  test_producer_against_consumer();
+  std::printf("spsc_queue: ok\n");
+  return 0;
+}
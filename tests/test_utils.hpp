@@ -0,0 +1,108 @@
+/*
+ * spacemouse_driver - User space driver for SpaceMouse devices
+ * Copyright (C) 2025 Łukasz Kuś
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Unlike assert() also checked in release builds
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      std::exit(1); \
+    } \
+  } while (false)
+
+namespace spacemouse_driver {
+namespace test {
+
+// Frame n holds n in every word, so a copy torn between two writes shows up as words of different
+// frames. With the default size copies take long enough to be preempted halfway even when readers
+// and writer share a single core.
+template<size_t N = 512>
+using FilledFrame = std::array<uint64_t, N>;
+
+template<size_t N = 512>
+FilledFrame<N> filled_frame(uint64_t number) {
+  FilledFrame<N> frame;
+  frame.fill(number);
+  return frame;
+}
+
+// Cap for writers that keep going until enough reads raced with them
+constexpr auto MAX_RACE_DURATION = std::chrono::seconds(10);
+
+// Runs writer once on its own thread while reader_count threads call reader(index) in a loop,
+// returns once the writer finished and every reader saw it finish
+template<typename Writer, typename Reader>
+void run_readers_against_writer(size_t reader_count, Writer&& writer, Reader&& reader) {
+  std::atomic<bool> done(false);
+  std::atomic<size_t> ready(0);
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < reader_count; ++i) {
+    readers.emplace_back(
+      [&, i] {
+        ready.fetch_add(1);
+        while (!done.load(std::memory_order_acquire)) {
+          reader(i);
+        }
+      });
+  }
+  // The race is only exercised once every reader is spinning
+  while (ready.load() < reader_count) {
+    std::this_thread::yield();
+  }
+  std::thread writer_thread(writer);
+  writer_thread.join();
+  done.store(true, std::memory_order_release);
+  for (auto& thread : readers) {
+    thread.join();
+  }
+}
+
+// Mean duration of one call in nanoseconds, measured over iterations calls after a warm up
+template<typename Function>
+double measure_ns(size_t iterations, Function&& function) {
+  for (size_t i = 0; i < iterations / 10; ++i) {
+    function(i);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    function(i);
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / static_cast<double>(iterations);
+}
+
+// Keeps the compiler from dropping a value computed only to be measured
+template<typename T>
+void do_not_optimize(const T& value) {
+  asm volatile ("" : : "r" (&value) : "memory");
+}
+
+}  // namespace test
+}  // namespace spacemouse_driver
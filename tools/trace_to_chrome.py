@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+#
+# spacemouse_driver - User space driver for SpaceMouse devices
+# Copyright (C) 2025 Łukasz Kuś
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+"""Converts a trace written by Driver::dump_trace() to Chrome trace JSON.
+
+Usage: trace_to_chrome.py TRACE [OUTPUT]
+
+The output opens in chrome://tracing or https://ui.perfetto.dev. Without OUTPUT the JSON is
+written next to TRACE with a .json extension.
+"""
+
+import json
+import os
+import struct
+import sys
+
+MAGIC = b"SMTRACE\0"
+VERSION = 1
+
+# Values of TraceEvent in src/util/trace_ring.hpp
+READ_RETURNED = 1
+PARSE_DONE = 2
+PUBLISHED = 3
+READ_ERROR = 4
+DISPATCH_WAKE = 5
+CALLBACK_BEGIN = 6
+CALLBACK_END = 7
+CONNECTED = 8
+DISCONNECTED = 9
+
+
+def instant(name, ts, tid, args=None, scope="t"):
+    event = {"name": name, "ph": "i", "s": scope, "ts": ts, "pid": 1, "tid": tid}
+    if args:
+        event["args"] = args
+    return event
+
+
+def convert(data):
+    if data[:8] != MAGIC:
+        raise ValueError("not a spacemouse_driver trace")
+    version, count = struct.unpack_from("<II", data, 8)
+    if version != VERSION:
+        raise ValueError("unsupported trace version %d" % version)
+
+    events = []
+    if count == 0:
+        return {"traceEvents": events}
+    records = [struct.unpack_from("<QQ", data, 16 + 16 * i) for i in range(count)]
+    origin = min(timestamp for timestamp, _ in records)
+    for timestamp, payload in records:
+        ts = (timestamp - origin) / 1000.0
+        arg = payload & 0xFFFFFFFF
+        kind = (payload >> 32) & 0xFFFF
+        tid = payload >> 48
+
+        if kind == READ_RETURNED:
+            events.append(instant("read", ts, tid, {"length": arg}))
+        elif kind == PARSE_DONE:
+            events.append(instant("parsed", ts, tid, {"reports": arg & 0xFFFF, "repeated": arg >> 16}))
+        elif kind == PUBLISHED:
+            events.append(instant("published", ts, tid, {"sequence": arg}))
+        elif kind == READ_ERROR:
+            events.append(instant("read error", ts, tid, scope="p"))
+        elif kind == DISPATCH_WAKE:
+            events.append(instant("dispatch wake", ts, tid, {"lateness_us": arg}))
+        elif kind in (CALLBACK_BEGIN, CALLBACK_END):
+            name = "callbacks" if arg == 0 else "subscription %d" % arg
+            phase = "B" if kind == CALLBACK_BEGIN else "E"
+            events.append({"name": name, "ph": phase, "ts": ts, "pid": 1, "tid": tid})
+        elif kind == CONNECTED:
+            events.append(instant("connected", ts, tid, scope="p"))
+        elif kind == DISCONNECTED:
+            events.append(instant("disconnected", ts, tid, scope="p"))
+
+    # A ring that wrapped may start inside a callback, its unmatched end is dropped
+    open_spans = {}
+    complete = []
+    for event in events:
+        key = (event["tid"], event["name"])
+        if event["ph"] == "B":
+            open_spans[key] = open_spans.get(key, 0) + 1
+        elif event["ph"] == "E":
+            if open_spans.get(key, 0) == 0:
+                continue
+            open_spans[key] -= 1
+        complete.append(event)
+    return {"traceEvents": complete, "displayTimeUnit": "ns"}
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write(__doc__)
+        return 2
+    output = argv[2] if len(argv) == 3 else os.path.splitext(argv[1])[0] + ".json"
+    if output == argv[1]:
+        # A trace named *.json must not be overwritten by its own conversion
+        output = argv[1] + ".json"
+    with open(argv[1], "rb") as trace:
+        data = trace.read()
+    try:
+        result = convert(data)
+    except (ValueError, struct.error) as error:
+        sys.stderr.write("%s: %s\n" % (argv[1], error))
+        return 1
+    with open(output, "w") as out:
+        json.dump(result, out)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))